@@ -3,17 +3,35 @@
  * Contains application firmware (can be write-protected via MPU)
  * Size: 64KB (16384 x 32-bit words)
  * Address Range: 0x00010000 - 0x0001FFFF
+ *
+ * Verification status (cleared only by power-on reset, kept across
+ * warm resets):
+ *   dirty  - set by any write and at power-on; cleared by mark_clean
+ *            when the boot ROM has verified the image
+ *   digest - 8-word signature the boot ROM recorded with mark_clean
+ * A warm reset with dirty clear lets the boot ROM skip the HMAC: the
+ * memory has not changed since the recorded signature was checked.
+ * A write in the same cycle as mark_clean leaves dirty set.
  */
 
 `timescale 1ns / 1ps
 
 module instruction_mem (
     input  wire        clk,
+    input  wire        por_n,        // Power-on reset (verification status)
     input  wire        we,           // Write enable
     input  wire [13:0] addr,         // 14-bit address for 16K words
     input  wire [31:0] wdata,        // Write data
     input  wire [3:0]  wstrb,        // Write strobe (byte enables)
-    output wire [31:0] rdata         // Read data (combinational)
+    output wire [31:0] rdata,        // Read data (combinational)
+
+    // Verification status (boot ROM)
+    input  wire [2:0]  digest_addr,  // Retained digest word
+    input  wire        digest_we,    // Record a digest word
+    input  wire [31:0] digest_wdata,
+    output wire [31:0] digest_rdata,
+    input  wire        mark_clean,   // Image verified: clear dirty
+    output reg         dirty         // Written since the last verification
 );
 
     // Instruction memory storage - 64KB
@@ -36,6 +54,27 @@ module instruction_mem (
             if (wstrb[3]) mem[addr][31:24] <= wdata[31:24];
         end
     end
+    
+    // Verification status
+    reg [31:0] digest [0:7];
+    integer i;
+    
+    assign digest_rdata = digest[digest_addr];
+    
+    always @(posedge clk or negedge por_n) begin
+        if (!por_n) begin
+            dirty <= 1'b1;                // Nothing verified yet
+            for (i = 0; i < 8; i = i + 1)
+                digest[i] <= 32'h00000000;
+        end else begin
+            if (we)
+                dirty <= 1'b1;
+            else if (mark_clean)
+                dirty <= 1'b0;
+
+            if (digest_we)
+                digest[digest_addr] <= digest_wdata;
+        end
+    end
 
 endmodule
-
@@ -0,0 +1,229 @@
+/*
+ * DMA Controller
+ *
+ * Word-wide memory-to-memory copy and fill engine. It is a master on
+ * the SoC bus (through the bus arbiter) and reaches any address the
+ * CPU can, subject to the same MPU checks.
+ *
+ * A copy moves one word every two bus cycles (read, then write) when
+ * the bus is free; a fill writes one word per cycle.
+ *
+ * Memory Map (base + offset):
+ *   0x00: SRC       - Source address, word aligned (R/W)
+ *   0x04: DST       - Destination address, word aligned (R/W)
+ *   0x08: LEN       - Transfer length in bytes, multiple of 4 (R/W)
+ *   0x0C: CTRL      - Control register (R/W, START self-clears)
+ *   0x10: STATUS    - Status register (R, write 1 to clear DONE/ERROR)
+ *   0x14: FILL      - Fill pattern for MODE_FILL (R/W)
+ *   0x18: REMAINING - Bytes left in the current transfer (R)
+ *
+ * CTRL bits:
+ *   0: START     - Begin transfer
+ *   1: MODE      - 0 = copy SRC -> DST, 1 = fill DST with FILL
+ *   2: IRQ_EN    - Raise irq while DONE is set
+ *   3: SRC_FIXED - Do not increment SRC (read a FIFO register)
+ *   4: DST_FIXED - Do not increment DST (write a FIFO register)
+ *
+ * STATUS bits:
+ *   0: BUSY  1: DONE  2: ERROR (misaligned setup or MPU fault)
+ */
+
+`timescale 1ns / 1ps
+
+module dma (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [2:0]  addr,        // Register address (byte offset / 4)
+    input  wire        we,          // Write enable
+    input  wire [31:0] wdata,       // Write data
+    output reg  [31:0] rdata,       // Read data
+
+    // Bus master interface
+    output wire        mem_valid,
+    output wire [31:0] mem_addr,
+    output wire [31:0] mem_wdata,
+    output wire [3:0]  mem_wstrb,
+    input  wire [31:0] mem_rdata,
+    input  wire        mem_ready,
+    input  wire        mem_error,   // MPU rejected the current access
+
+    // Interrupt request (transfer done)
+    output wire        irq
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_SRC       = 3'h0;
+    localparam ADDR_DST       = 3'h1;
+    localparam ADDR_LEN       = 3'h2;
+    localparam ADDR_CTRL      = 3'h3;
+    localparam ADDR_STATUS    = 3'h4;
+    localparam ADDR_FILL      = 3'h5;
+    localparam ADDR_REMAINING = 3'h6;
+
+    //=================================================================
+    // Control / Status Bits
+    //=================================================================
+    localparam CTRL_START     = 0;
+    localparam CTRL_MODE      = 1;
+    localparam CTRL_IRQ_EN    = 2;
+    localparam CTRL_SRC_FIXED = 3;
+    localparam CTRL_DST_FIXED = 4;
+
+    localparam STATUS_BUSY    = 0;
+    localparam STATUS_DONE    = 1;
+    localparam STATUS_ERROR   = 2;
+
+    //=================================================================
+    // State Machine
+    //=================================================================
+    localparam IDLE  = 2'd0;
+    localparam READ  = 2'd1;
+    localparam WRITE = 2'd2;
+
+    reg [1:0]  state;
+
+    reg [31:0] src_reg;
+    reg [31:0] dst_reg;
+    reg [31:0] len_reg;
+    reg [4:0]  ctrl_reg;
+    reg [31:0] fill_reg;
+    reg        done;
+    reg        error;
+
+    // Working copies (SRC/DST/LEN keep the programmed values)
+    reg [31:0] cur_src;
+    reg [31:0] cur_dst;
+    reg [31:0] remaining;
+    reg [31:0] data_buf;
+
+    wire busy = (state != IDLE);
+
+    assign mem_valid = (state == READ) || (state == WRITE);
+    assign mem_addr  = (state == READ) ? cur_src : cur_dst;
+    assign mem_wdata = ctrl_reg[CTRL_MODE] ? fill_reg : data_buf;
+    assign mem_wstrb = (state == WRITE) ? 4'b1111 : 4'b0000;
+
+    assign irq = done && ctrl_reg[CTRL_IRQ_EN];
+
+    wire start_req = we && (addr == ADDR_CTRL) && wdata[CTRL_START] && !busy;
+    // SRC is unused in fill mode, so only DST and LEN must be aligned
+    wire src_misaligned = !wdata[CTRL_MODE] && (src_reg[1:0] != 2'b00);
+    wire misaligned     = src_misaligned || (dst_reg[1:0] != 2'b00) || (len_reg[1:0] != 2'b00);
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state     <= IDLE;
+            src_reg   <= 32'h0;
+            dst_reg   <= 32'h0;
+            len_reg   <= 32'h0;
+            ctrl_reg  <= 5'h0;
+            fill_reg  <= 32'h0;
+            done      <= 1'b0;
+            error     <= 1'b0;
+            cur_src   <= 32'h0;
+            cur_dst   <= 32'h0;
+            remaining <= 32'h0;
+            data_buf  <= 32'h0;
+        end else begin
+            //---------------------------------------------------------
+            // Register writes (configuration is ignored while busy)
+            //---------------------------------------------------------
+            if (we && !busy) begin
+                case (addr)
+                    ADDR_SRC:  src_reg  <= wdata;
+                    ADDR_DST:  dst_reg  <= wdata;
+                    ADDR_LEN:  len_reg  <= wdata;
+                    ADDR_FILL: fill_reg <= wdata;
+                    ADDR_CTRL: ctrl_reg <= {wdata[4:1], 1'b0};
+                    default: ;
+                endcase
+            end
+
+            if (we && addr == ADDR_STATUS) begin
+                if (wdata[STATUS_DONE])  done  <= 1'b0;
+                if (wdata[STATUS_ERROR]) error <= 1'b0;
+            end
+
+            //---------------------------------------------------------
+            // Transfer
+            //---------------------------------------------------------
+            case (state)
+                IDLE: begin
+                    if (start_req) begin
+                        done  <= 1'b0;
+                        error <= 1'b0;
+                        if (misaligned) begin
+                            error <= 1'b1;
+                            done  <= 1'b1;
+                        end else if (len_reg == 32'h0) begin
+                            done <= 1'b1;
+                        end else begin
+                            cur_src   <= src_reg;
+                            cur_dst   <= dst_reg;
+                            remaining <= len_reg;
+                            state     <= wdata[CTRL_MODE] ? WRITE : READ;
+                        end
+                    end
+                end
+
+                READ: begin
+                    if (mem_ready) begin
+                        if (mem_error) begin
+                            error <= 1'b1;
+                            done  <= 1'b1;
+                            state <= IDLE;
+                        end else begin
+                            data_buf <= mem_rdata;
+                            if (!ctrl_reg[CTRL_SRC_FIXED])
+                                cur_src <= cur_src + 4;
+                            state <= WRITE;
+                        end
+                    end
+                end
+
+                WRITE: begin
+                    if (mem_ready) begin
+                        if (mem_error) begin
+                            error <= 1'b1;
+                            done  <= 1'b1;
+                            state <= IDLE;
+                        end else begin
+                            if (!ctrl_reg[CTRL_DST_FIXED])
+                                cur_dst <= cur_dst + 4;
+                            remaining <= remaining - 4;
+                            if (remaining == 32'd4) begin
+                                done  <= 1'b1;
+                                state <= IDLE;
+                            end else begin
+                                state <= ctrl_reg[CTRL_MODE] ? WRITE : READ;
+                            end
+                        end
+                    end
+                end
+
+                default: state <= IDLE;
+            endcase
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        case (addr)
+            ADDR_SRC:       rdata = src_reg;
+            ADDR_DST:       rdata = dst_reg;
+            ADDR_LEN:       rdata = len_reg;
+            ADDR_CTRL:      rdata = {27'h0, ctrl_reg};
+            ADDR_STATUS:    rdata = {29'h0, error, done, busy};
+            ADDR_FILL:      rdata = fill_reg;
+            ADDR_REMAINING: rdata = remaining;
+            default:        rdata = 32'h0;
+        endcase
+    end
+
+endmodule
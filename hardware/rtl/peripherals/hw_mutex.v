@@ -0,0 +1,111 @@
+/*
+ * Hart Control and Hardware Mutex
+ *
+ * Identifies the requesting hart and provides read-to-acquire mutexes
+ * for sharing peripherals (crypto, anti-replay, UART) between harts.
+ * The requester is the bus arbiter grant index, so no CSR support is
+ * needed in the CPU.
+ *
+ * Memory Map (base + offset):
+ *   0x00: HART_ID      - ID of the hart performing the read (R)
+ *   0x04: NUM_HARTS    - Number of harts in this build (R)
+ *   0x08: HART_RELEASE - Bit n releases hart n from the boot ROM (R/W)
+ *   0x0C: LOCKED       - Bitmap of held mutexes (R)
+ *   0x20-0x3C: MUTEX[0..7]
+ *       Read:  1 = acquired (or already held by this hart), 0 = busy
+ *       Write: release (ignored unless written by the owner)
+ */
+
+`timescale 1ns / 1ps
+
+module hw_mutex #(
+    parameter NUM_HARTS = 2,
+    parameter NUM_MUTEX = 8,
+    parameter ID_WIDTH  = 2
+)(
+    input  wire                clk,
+    input  wire                rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [3:0]          addr,        // Register address (byte offset / 4)
+    input  wire                we,          // Write enable
+    input  wire                re,          // Read strobe (acquire side effect)
+    input  wire [31:0]         wdata,       // Write data
+    output reg  [31:0]         rdata,       // Read data
+    input  wire [ID_WIDTH-1:0] hart_id      // Requesting master (arbiter grant)
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_HART_ID      = 4'h0;
+    localparam ADDR_NUM_HARTS    = 4'h1;
+    localparam ADDR_HART_RELEASE = 4'h2;
+    localparam ADDR_LOCKED       = 4'h3;
+    localparam ADDR_MUTEX_BASE   = 4'h8;   // 0x20 / 4
+
+    //=================================================================
+    // Registers
+    //=================================================================
+    reg [NUM_HARTS-1:0] release_reg;
+    reg [NUM_MUTEX-1:0] locked;
+    reg [ID_WIDTH-1:0]  owner [0:NUM_MUTEX-1];
+
+    wire             mutex_access = addr[3];
+    wire [2:0]       mutex_idx    = addr[2:0];
+    wire             mutex_free   = !locked[mutex_idx];
+    wire             mutex_mine   = locked[mutex_idx] && (owner[mutex_idx] == hart_id);
+
+    // Hart 0 is never parked
+    wire [NUM_HARTS-1:0] hart_release = release_reg | 1'b1;
+
+    //=================================================================
+    // Acquire / Release Logic
+    //=================================================================
+    integer i;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            release_reg <= {NUM_HARTS{1'b0}};
+            locked      <= {NUM_MUTEX{1'b0}};
+            for (i = 0; i < NUM_MUTEX; i = i + 1) begin
+                owner[i] <= {ID_WIDTH{1'b0}};
+            end
+        end else begin
+            // Read of a free mutex takes it
+            if (re && mutex_access && mutex_idx < NUM_MUTEX && mutex_free) begin
+                locked[mutex_idx] <= 1'b1;
+                owner[mutex_idx]  <= hart_id;
+            end
+
+            if (we) begin
+                if (mutex_access) begin
+                    if (mutex_idx < NUM_MUTEX && mutex_mine) begin
+                        locked[mutex_idx] <= 1'b0;
+                    end
+                end else if (addr == ADDR_HART_RELEASE) begin
+                    release_reg <= wdata[NUM_HARTS-1:0];
+                end
+            end
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        rdata = 32'h0;
+        if (mutex_access) begin
+            if (mutex_idx < NUM_MUTEX)
+                rdata = {31'h0, mutex_free || mutex_mine};
+        end else begin
+            case (addr)
+                ADDR_HART_ID:      rdata[ID_WIDTH-1:0] = hart_id;
+                ADDR_NUM_HARTS:    rdata = NUM_HARTS;
+                ADDR_HART_RELEASE: rdata[NUM_HARTS-1:0] = hart_release;
+                ADDR_LOCKED:       rdata[NUM_MUTEX-1:0] = locked;
+                default:           rdata = 32'h0;
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,110 @@
+/*
+ * Interrupt Controller
+ *
+ * Collects peripheral interrupt requests and forwards them to the
+ * PicoRV32 IRQ inputs. Each source is edge-detected and latched in
+ * PENDING until software clears it, so level and pulse sources are
+ * handled the same way.
+ *
+ * PicoRV32 latches its IRQ inputs (LATCHED_IRQ), so each output line
+ * is a one-cycle pulse when a source becomes pending AND enabled.
+ * Holding the line high would re-latch the IRQ inside the core while
+ * the handler is still running.
+ *
+ * Memory Map (base + offset):
+ *   0x00: PENDING  - Latched requests (R, write 1 to clear)
+ *   0x04: ENABLE   - Per-source enable mask (R/W)
+ *   0x08: STATUS   - PENDING & ENABLE (R)
+ *   0x0C: RAW      - Current source levels (R)
+ *   0x10: FORCE    - Write 1 to set PENDING bits (W, for testing)
+ *
+ * Sources (see soc_top.v, IRQ_SRC_* in soc_map.h):
+ *   0: Timer        1: UART TX      2: Crypto     3: Anti-Replay
+ *   4: DMA          5: MPU fault    6: UART RX    7: UART TX DMA
+ */
+
+`timescale 1ns / 1ps
+
+module irq_ctrl #(
+    parameter NUM_SRC = 8
+)(
+    input  wire               clk,
+    input  wire               rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [2:0]         addr,        // Register address (byte offset / 4)
+    input  wire               we,          // Write enable
+    input  wire [31:0]        wdata,       // Write data
+    output reg  [31:0]        rdata,       // Read data
+
+    // Interrupt sources and CPU lines
+    input  wire [NUM_SRC-1:0] irq_src,     // Peripheral requests (level)
+    output reg  [NUM_SRC-1:0] irq_out      // One-cycle pulses to CPU
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_PENDING = 3'h0;
+    localparam ADDR_ENABLE  = 3'h1;
+    localparam ADDR_STATUS  = 3'h2;
+    localparam ADDR_RAW     = 3'h3;
+    localparam ADDR_FORCE   = 3'h4;
+
+    //=================================================================
+    // Internal Registers
+    //=================================================================
+    reg [NUM_SRC-1:0] pending;
+    reg [NUM_SRC-1:0] enable;
+    reg [NUM_SRC-1:0] src_prev;
+    reg [NUM_SRC-1:0] active_prev;
+
+    wire [NUM_SRC-1:0] src_rise = irq_src & ~src_prev;
+    wire [NUM_SRC-1:0] active   = pending & enable;
+
+    //=================================================================
+    // Pending / Enable Logic
+    //=================================================================
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            pending     <= {NUM_SRC{1'b0}};
+            enable      <= {NUM_SRC{1'b0}};
+            src_prev    <= {NUM_SRC{1'b0}};
+            active_prev <= {NUM_SRC{1'b0}};
+            irq_out     <= {NUM_SRC{1'b0}};
+        end else begin
+            src_prev    <= irq_src;
+            active_prev <= active;
+
+            // Pulse once for every source that just became active
+            irq_out <= active & ~active_prev;
+
+            // New edges take priority over a simultaneous clear so an
+            // event arriving while software acknowledges is not lost
+            if (we && addr == ADDR_PENDING)
+                pending <= (pending & ~wdata[NUM_SRC-1:0]) | src_rise;
+            else if (we && addr == ADDR_FORCE)
+                pending <= pending | wdata[NUM_SRC-1:0] | src_rise;
+            else
+                pending <= pending | src_rise;
+
+            if (we && addr == ADDR_ENABLE)
+                enable <= wdata[NUM_SRC-1:0];
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        rdata = 32'h0;
+        case (addr)
+            ADDR_PENDING: rdata[NUM_SRC-1:0] = pending;
+            ADDR_ENABLE:  rdata[NUM_SRC-1:0] = enable;
+            ADDR_STATUS:  rdata[NUM_SRC-1:0] = active;
+            ADDR_RAW:     rdata[NUM_SRC-1:0] = irq_src;
+            default:      rdata = 32'h0;
+        endcase
+    end
+
+endmodule
@@ -0,0 +1,119 @@
+/*
+ * Timer Peripheral
+ *
+ * 32-bit up-counter with compare match and optional auto-reload.
+ * The MATCH flag drives the interrupt controller (timer source).
+ *
+ * Memory Map (base + offset):
+ *   0x00: COUNT    - Current count (R/W)
+ *   0x04: COMPARE  - Match value (R/W)
+ *   0x08: CTRL     - Control register (R/W)
+ *   0x0C: STATUS   - Status register (R, write 1 to clear MATCH)
+ *   0x10: PRESCALE - Count every PRESCALE+1 cycles (R/W)
+ */
+
+`timescale 1ns / 1ps
+
+module timer (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [2:0]  addr,        // Register address (byte offset / 4)
+    input  wire        we,          // Write enable
+    input  wire [31:0] wdata,       // Write data
+    output reg  [31:0] rdata,       // Read data
+
+    // Interrupt request (level, held until MATCH is cleared)
+    output wire        irq
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_COUNT    = 3'h0;
+    localparam ADDR_COMPARE  = 3'h1;
+    localparam ADDR_CTRL     = 3'h2;
+    localparam ADDR_STATUS   = 3'h3;
+    localparam ADDR_PRESCALE = 3'h4;
+
+    //=================================================================
+    // Control / Status Bits
+    //=================================================================
+    localparam CTRL_ENABLE      = 0;  // Counter running
+    localparam CTRL_AUTO_RELOAD = 1;  // Restart from 0 on match (periodic)
+    localparam CTRL_IRQ_EN      = 2;  // Drive irq on match
+
+    localparam STATUS_MATCH     = 0;  // COUNT reached COMPARE
+
+    //=================================================================
+    // Registers
+    //=================================================================
+    reg [31:0] count;
+    reg [31:0] compare;
+    reg [2:0]  ctrl;
+    reg        match;
+    reg [15:0] prescale;
+    reg [15:0] prescale_cnt;
+
+    wire tick = (prescale_cnt == prescale);
+
+    assign irq = match && ctrl[CTRL_IRQ_EN];
+
+    //=================================================================
+    // Counter Logic
+    //=================================================================
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            count        <= 32'h0;
+            compare      <= 32'hFFFFFFFF;
+            ctrl         <= 3'b000;
+            match        <= 1'b0;
+            prescale     <= 16'h0;
+            prescale_cnt <= 16'h0;
+        end else begin
+            // Count
+            if (ctrl[CTRL_ENABLE]) begin
+                prescale_cnt <= tick ? 16'h0 : prescale_cnt + 1;
+                if (tick) begin
+                    if (count == compare) begin
+                        match <= 1'b1;
+                        count <= ctrl[CTRL_AUTO_RELOAD] ? 32'h0 : count + 1;
+                    end else begin
+                        count <= count + 1;
+                    end
+                end
+            end
+
+            // Register writes (override counter updates)
+            if (we) begin
+                case (addr)
+                    ADDR_COUNT: begin
+                        count <= wdata;
+                        prescale_cnt <= 16'h0;
+                    end
+                    ADDR_COMPARE:  compare <= wdata;
+                    ADDR_CTRL:     ctrl <= wdata[2:0];
+                    ADDR_STATUS:   if (wdata[STATUS_MATCH]) match <= 1'b0;
+                    ADDR_PRESCALE: prescale <= wdata[15:0];
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        case (addr)
+            ADDR_COUNT:    rdata = count;
+            ADDR_COMPARE:  rdata = compare;
+            ADDR_CTRL:     rdata = {29'h0, ctrl};
+            ADDR_STATUS:   rdata = {31'h0, match};
+            ADDR_PRESCALE: rdata = {16'h0, prescale};
+            default:       rdata = 32'h0;
+        endcase
+    end
+
+endmodule
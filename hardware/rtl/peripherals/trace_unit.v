@@ -0,0 +1,227 @@
+/*
+ * Instruction Trace Unit
+ *
+ * Captures PicoRV32 trace port records (ENABLE_TRACE) into a circular
+ * buffer. Capture runs at full speed and freezes on a SoC trap, so the
+ * last DEPTH records before an MPU violation or CPU trap can be read
+ * back by firmware or dumped by the testbench and decoded on the host
+ * (software/tools/trace_decode.py).
+ *
+ * PicoRV32 emits one record per retired instruction (taken branch
+ * target or written register value) plus one address record per load
+ * and store. Every captured entry stores the number of instruction
+ * records seen since the previous captured entry, so a branch-only
+ * trace still tells the decoder how many instructions ran in between.
+ *
+ * Entry format:
+ *   DATA: record payload (branch target, load/store address or value)
+ *   INFO: [31:4] instruction delta, [3] IRQ, [2] reserved,
+ *         [1] ADDR record, [0] BRANCH record
+ *
+ * Memory Map (base + offset):
+ *   0x00: CTRL      - Control register (R/W)
+ *   0x04: STATUS    - Status register (R)
+ *   0x08: TRIG_ADDR - Start capture at a record with this payload (R/W)
+ *   0x0C: STOP_ADDR - Stop capture after a record with this payload (R/W)
+ *   0x10: WR_PTR    - Index of the next entry to be written (R)
+ *   0x14: COUNT     - Entries captured since CLEAR, saturating (R)
+ *   0x18: RD_IDX    - Entry selected for RD_DATA/RD_INFO (R/W)
+ *   0x1C: RD_DATA   - DATA of entry RD_IDX (R)
+ *   0x20: RD_INFO   - INFO of entry RD_IDX (R)
+ *   0x24: DEPTH     - Buffer size in entries (R)
+ *
+ * CTRL bits (reset: ENABLE | CAP_BRANCH | STOP_ON_TRAP):
+ *   0: ENABLE       - Capture records
+ *   1: CAP_BRANCH   - Capture taken branch / jump / IRQ return targets
+ *   2: CAP_ADDR     - Capture load / store addresses
+ *   3: CAP_DATA     - Capture register write values
+ *   4: STOP_ON_TRAP - Freeze when the SoC trap line rises
+ *   5: TRIG_EN      - Wait for TRIG_ADDR before capturing
+ *   6: STOP_EN      - Freeze after STOP_ADDR
+ *   7: CLEAR        - Reset pointer, count and status (self-clearing)
+ *
+ * STATUS bits:
+ *   0: RUNNING  1: TRIGGERED  2: STOPPED  3: WRAPPED
+ */
+
+`timescale 1ns / 1ps
+
+module trace_unit #(
+    parameter DEPTH      = 256,
+    parameter ADDR_WIDTH = 8       // log2(DEPTH)
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [3:0]  addr,        // Register address (byte offset / 4)
+    input  wire        we,          // Write enable
+    input  wire [31:0] wdata,       // Write data
+    output reg  [31:0] rdata,       // Read data
+
+    // PicoRV32 trace port
+    input  wire        trace_valid,
+    input  wire [35:0] trace_data,
+
+    // SoC trap (freezes capture when STOP_ON_TRAP is set)
+    input  wire        trap
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_CTRL      = 4'h0;
+    localparam ADDR_STATUS    = 4'h1;
+    localparam ADDR_TRIG_ADDR = 4'h2;
+    localparam ADDR_STOP_ADDR = 4'h3;
+    localparam ADDR_WR_PTR    = 4'h4;
+    localparam ADDR_COUNT     = 4'h5;
+    localparam ADDR_RD_IDX    = 4'h6;
+    localparam ADDR_RD_DATA   = 4'h7;
+    localparam ADDR_RD_INFO   = 4'h8;
+    localparam ADDR_DEPTH     = 4'h9;
+
+    //=================================================================
+    // Control Bits
+    //=================================================================
+    localparam CTRL_ENABLE       = 0;
+    localparam CTRL_CAP_BRANCH   = 1;
+    localparam CTRL_CAP_ADDR     = 2;
+    localparam CTRL_CAP_DATA     = 3;
+    localparam CTRL_STOP_ON_TRAP = 4;
+    localparam CTRL_TRIG_EN      = 5;
+    localparam CTRL_STOP_EN      = 6;
+    localparam CTRL_CLEAR        = 7;
+
+    localparam CTRL_RESET = (1 << CTRL_ENABLE) | (1 << CTRL_CAP_BRANCH) |
+                            (1 << CTRL_STOP_ON_TRAP);
+
+    //=================================================================
+    // Registers
+    //=================================================================
+    reg [6:0]            ctrl_reg;
+    reg [31:0]           trig_addr;
+    reg [31:0]           stop_addr;
+    reg [ADDR_WIDTH-1:0] rd_idx;
+    reg [ADDR_WIDTH-1:0] wr_ptr;
+    reg [31:0]           count;
+    reg [27:0]           instr_delta;
+    reg                  triggered;
+    reg                  stopped;
+    reg                  wrapped;
+    reg                  trap_prev;
+
+    reg [31:0] buf_data [0:DEPTH-1];
+    reg [31:0] buf_info [0:DEPTH-1];
+
+    //=================================================================
+    // Record Classification (PicoRV32 TRACE_* encodings)
+    //=================================================================
+    wire rec_branch = trace_data[32];
+    wire rec_addr   = trace_data[33];
+    wire rec_irq    = trace_data[35];
+    wire rec_instr  = !rec_addr;        // One per retired instruction
+    wire rec_data   = !rec_branch && !rec_addr;
+
+    wire rec_wanted = (rec_branch && ctrl_reg[CTRL_CAP_BRANCH]) ||
+                      (rec_addr   && ctrl_reg[CTRL_CAP_ADDR])   ||
+                      (rec_data   && ctrl_reg[CTRL_CAP_DATA]);
+
+    wire running   = ctrl_reg[CTRL_ENABLE] && !stopped;
+    wire trig_hit  = trace_data[31:0] == trig_addr;
+    wire armed     = !ctrl_reg[CTRL_TRIG_EN] || triggered || trig_hit;
+    wire capture   = trace_valid && running && armed && rec_wanted;
+
+    // Instruction count up to and including this record
+    wire [27:0] delta_now = instr_delta + (rec_instr ? 28'd1 : 28'd0);
+    wire [27:0] delta_sat = (instr_delta == 28'hFFFFFFF) ? instr_delta : delta_now;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            ctrl_reg    <= CTRL_RESET;
+            trig_addr   <= 32'h0;
+            stop_addr   <= 32'h0;
+            rd_idx      <= {ADDR_WIDTH{1'b0}};
+            wr_ptr      <= {ADDR_WIDTH{1'b0}};
+            count       <= 32'h0;
+            instr_delta <= 28'h0;
+            triggered   <= 1'b0;
+            stopped     <= 1'b0;
+            wrapped     <= 1'b0;
+            trap_prev   <= 1'b0;
+        end else begin
+            trap_prev <= trap;
+
+            //---------------------------------------------------------
+            // Capture
+            //---------------------------------------------------------
+            if (trace_valid && running && armed) begin
+                if (ctrl_reg[CTRL_TRIG_EN] && trig_hit)
+                    triggered <= 1'b1;
+
+                if (capture) begin
+                    buf_data[wr_ptr] <= trace_data[31:0];
+                    buf_info[wr_ptr] <= {delta_sat, rec_irq, 1'b0, rec_addr, rec_branch};
+                    wr_ptr           <= wr_ptr + 1'b1;
+                    instr_delta      <= 28'h0;
+                    if (wr_ptr == DEPTH - 1)
+                        wrapped <= 1'b1;
+                    if (count != 32'hFFFFFFFF)
+                        count <= count + 1;
+                end else if (rec_instr && instr_delta != 28'hFFFFFFF) begin
+                    instr_delta <= delta_now;
+                end
+
+                if (ctrl_reg[CTRL_STOP_EN] && trace_data[31:0] == stop_addr)
+                    stopped <= 1'b1;
+            end
+
+            if (ctrl_reg[CTRL_STOP_ON_TRAP] && trap && !trap_prev)
+                stopped <= 1'b1;
+
+            //---------------------------------------------------------
+            // Register writes
+            //---------------------------------------------------------
+            if (we) begin
+                case (addr)
+                    ADDR_CTRL: begin
+                        ctrl_reg <= wdata[6:0];
+                        if (wdata[CTRL_CLEAR]) begin
+                            wr_ptr      <= {ADDR_WIDTH{1'b0}};
+                            count       <= 32'h0;
+                            instr_delta <= 28'h0;
+                            triggered   <= 1'b0;
+                            stopped     <= 1'b0;
+                            wrapped     <= 1'b0;
+                        end
+                    end
+                    ADDR_TRIG_ADDR: trig_addr <= wdata;
+                    ADDR_STOP_ADDR: stop_addr <= wdata;
+                    ADDR_RD_IDX:    rd_idx    <= wdata[ADDR_WIDTH-1:0];
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        case (addr)
+            ADDR_CTRL:      rdata = {25'h0, ctrl_reg};
+            ADDR_STATUS:    rdata = {28'h0, wrapped, stopped,
+                                     triggered || !ctrl_reg[CTRL_TRIG_EN], running};
+            ADDR_TRIG_ADDR: rdata = trig_addr;
+            ADDR_STOP_ADDR: rdata = stop_addr;
+            ADDR_WR_PTR:    rdata = wr_ptr;
+            ADDR_COUNT:     rdata = count;
+            ADDR_RD_IDX:    rdata = rd_idx;
+            ADDR_RD_DATA:   rdata = buf_data[rd_idx];
+            ADDR_RD_INFO:   rdata = buf_info[rd_idx];
+            ADDR_DEPTH:     rdata = DEPTH;
+            default:        rdata = 32'h0;
+        endcase
+    end
+
+endmodule
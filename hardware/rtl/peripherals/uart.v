@@ -1,44 +1,136 @@
 /*
- * Simple UART Module for Debug Output
- * Memory-mapped registers for character transmission
+ * Simple UART Module for Debug Output and Host Input
+ * Memory-mapped registers for character transmission and reception
  * Address Range: 0x20000000 - 0x200000FF
- * 
+ *
+ * The UART is also a bus master: a TX DMA job (buffer address and
+ * length) is fetched from memory and queued without the CPU.
+ *
  * Register Map:
- *   0x00: TX Data Register (write to send character)
- *   0x04: Status Register (bit 0: TX busy)
+ *   0x00: TX Data Register (write to queue character)
+ *   0x04: Status Register (R, write 1 to bits 3/6/7 clears them)
+ *   0x08: TX Threshold (R/W, reset 1)
+ *   0x0C: TX FIFO size in bytes (R)
+ *   0x10: RX Data Register (R, pops: [7:0] data, [8] valid)
+ *   0x14: Baud divisor, clocks per bit (R/W, reset CLK_FREQ/BAUD_RATE,
+ *         minimum 8)
+ *   0x18: RX Threshold (R/W, reset 1, 0 disables irq_rx)
+ *   0x1C: RX FIFO size in bytes (R)
+ *   0x20: TX DMA address, any byte address (R/W)
+ *   0x24: TX DMA length in bytes (W starts a job, R bytes left)
+ *   0x28: TX DMA control, bit 0 IRQ_EN (R/W)
+ *   0x2C: TX DMA status (R, write 1 to clear DONE/ERROR):
+ *         0 BUSY, 1 DONE, 2 ERROR (MPU fault, job stopped)
+ *
+ * Status bits:
+ *   0:     TX_BUSY      - Characters queued or being sent
+ *   1:     TX_FULL      - FIFO full, a write now is dropped
+ *   2:     TX_EMPTY     - FIFO empty and transmitter idle
+ *   3:     TX_OVERRUN   - A character was dropped (sticky)
+ *   4:     RX_READY     - RX FIFO not empty
+ *   5:     RX_FULL      - RX FIFO full
+ *   6:     RX_OVERRUN   - A received character was dropped (sticky)
+ *   7:     RX_FRAME_ERR - A character had no stop bit (sticky)
+ *   12:8:  RX_LEVEL     - Characters in the RX FIFO
+ *   31:16: TX_LEVEL     - Characters queued, including the one being sent
+ *
+ * Characters queue in a TX_FIFO_DEPTH byte FIFO, so firmware only
+ * waits when it is full (TX_FULL) instead of for every character.
+ *
+ * The receiver samples each bit three times around its centre (one
+ * clock apart) and takes the majority, so a glitch shorter than a
+ * clock is ignored. A start bit that is high at its centre is dropped.
+ * With a 100 MHz clock the divisor allows up to 12.5 Mbaud; 1-3 Mbaud
+ * is 100-33 clocks per bit.
+ *
+ * Interrupts: irq is high while TX_LEVEL is below the TX threshold, so
+ * the interrupt controller sees a rising edge when the FIFO drains
+ * below it (threshold 1: when the last character has been sent).
+ * irq_rx is high while RX_LEVEL is at or above the RX threshold.
+ * irq_dma is high while TX DMA DONE is set with IRQ_EN.
+ *
+ * TX DMA: writing the length starts a job (ignored while one is
+ * running). The UART reads each word once, as bus master, and queues
+ * its bytes as the FIFO has room, so a log line costs firmware two
+ * stores. Bytes are sent unchanged (no LF to CRLF). CPU writes to TX
+ * during a job are queued between DMA bytes.
  */
 
 `timescale 1ns / 1ps
 
 module uart #(
     parameter CLK_FREQ = 100000000,  // 100 MHz
-    parameter BAUD_RATE = 115200
+    parameter BAUD_RATE = 115200,
+    parameter TX_FIFO_DEPTH = 64,    // 64-256 bytes
+    parameter TX_FIFO_BITS  = 6,     // log2(TX_FIFO_DEPTH)
+    parameter RX_FIFO_DEPTH = 16,
+    parameter RX_FIFO_BITS  = 4      // log2(RX_FIFO_DEPTH)
 )(
     input  wire        clk,
     input  wire        rst_n,
-    
+
     // Memory-mapped interface
-    input  wire [3:0]  addr,
+    input  wire [3:0]  addr,         // Register address (byte offset / 4)
     input  wire        we,
+    input  wire        re,           // Read strobe (pops RX data)
     input  wire [31:0] wdata,
     output reg  [31:0] rdata,
-    
+
+    // Bus master interface (TX DMA reads)
+    output wire        mem_valid,
+    output wire [31:0] mem_addr,
+    input  wire [31:0] mem_rdata,
+    input  wire        mem_ready,
+    input  wire        mem_error,    // MPU rejected the read
+
     // UART signals
     output reg         tx,
-    input  wire        rx
+    input  wire        rx,
+
+    // Interrupt requests
+    output wire        irq,          // TX level below threshold
+    output wire        irq_rx,       // RX level at or above threshold
+    output wire        irq_dma       // TX DMA job done
 );
 
-    // Baud rate generator
-    localparam DIVISOR = CLK_FREQ / BAUD_RATE;
+    // Register map (word index)
+    localparam ADDR_TX        = 4'h0;
+    localparam ADDR_STATUS    = 4'h1;
+    localparam ADDR_TX_THRESH = 4'h2;
+    localparam ADDR_TX_SIZE   = 4'h3;
+    localparam ADDR_RX_DATA   = 4'h4;
+    localparam ADDR_BAUD_DIV  = 4'h5;
+    localparam ADDR_RX_THRESH = 4'h6;
+    localparam ADDR_RX_SIZE   = 4'h7;
+    localparam ADDR_DMA_ADDR  = 4'h8;
+    localparam ADDR_DMA_LEN   = 4'h9;
+    localparam ADDR_DMA_CTRL  = 4'hA;
+    localparam ADDR_DMA_STAT  = 4'hB;
+
+    localparam STATUS_TX_OVERRUN  = 3;
+    localparam STATUS_RX_OVERRUN  = 6;
+    localparam STATUS_RX_FRAME_ERR = 7;
+
+    localparam DMA_STAT_DONE  = 1;
+    localparam DMA_STAT_ERROR = 2;
+
+    // Baud rate generator (divisor programmable at run time)
+    localparam DIVISOR  = CLK_FREQ / BAUD_RATE;
+    localparam DIV_MIN  = 8;
+    reg [15:0] baud_div;
     reg [15:0] baud_counter;
     reg baud_tick;
-    
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
+            baud_div <= DIVISOR;
             baud_counter <= 0;
             baud_tick <= 0;
         end else begin
-            if (baud_counter == DIVISOR - 1) begin
+            if (we && addr == ADDR_BAUD_DIV)
+                baud_div <= (wdata[15:0] < DIV_MIN) ? DIV_MIN : wdata[15:0];
+
+            if (baud_counter >= baud_div - 1) begin
                 baud_counter <= 0;
                 baud_tick <= 1;
             end else begin
@@ -47,18 +139,42 @@ module uart #(
             end
         end
     end
-    
+
+    // TX FIFO
+    reg [7:0]              tx_fifo [0:TX_FIFO_DEPTH-1];
+    reg [TX_FIFO_BITS-1:0] tx_head;
+    reg [TX_FIFO_BITS-1:0] tx_tail;
+    reg [TX_FIFO_BITS:0]   tx_count;
+    reg [TX_FIFO_BITS+1:0] tx_thresh;
+    reg                    tx_overrun;
+
     // TX state machine
     localparam TX_IDLE  = 2'd0;
     localparam TX_START = 2'd1;
     localparam TX_DATA  = 2'd2;
     localparam TX_STOP  = 2'd3;
-    
+
     reg [1:0]  tx_state;
     reg [7:0]  tx_data;
     reg [2:0]  tx_bit_cnt;
-    reg        tx_busy;
-    
+    reg        tx_busy;             // Transmitter shifting a character
+
+    wire tx_full  = (tx_count == TX_FIFO_DEPTH);
+    wire cpu_push = we && (addr == ADDR_TX) && !tx_full;
+    wire dma_push;
+    wire [7:0] dma_byte;
+    wire tx_push  = cpu_push || dma_push;
+    wire tx_pop   = (tx_state == TX_IDLE) && (tx_count != 0);
+
+    wire [TX_FIFO_BITS+1:0] tx_level = tx_count + tx_busy;
+
+    assign irq = (tx_level < tx_thresh);
+
+    always @(posedge clk) begin
+        if (tx_push)
+            tx_fifo[tx_tail] <= cpu_push ? wdata[7:0] : dma_byte;
+    end
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             tx_state <= TX_IDLE;
@@ -66,17 +182,36 @@ module uart #(
             tx_data <= 8'h00;
             tx_bit_cnt <= 0;
             tx_busy <= 0;
+            tx_head <= 0;
+            tx_tail <= 0;
+            tx_count <= 0;
+            tx_thresh <= 1;
+            tx_overrun <= 1'b0;
         end else begin
+            // Queue writes; a write to a full FIFO is dropped
+            if (tx_push)
+                tx_tail <= tx_tail + 1'b1;
+            if (tx_pop)
+                tx_head <= tx_head + 1'b1;
+            tx_count <= tx_count + tx_push - tx_pop;
+
+            if (we && addr == ADDR_TX && tx_full)
+                tx_overrun <= 1'b1;
+            if (we && addr == ADDR_STATUS && wdata[STATUS_TX_OVERRUN])
+                tx_overrun <= 1'b0;
+            if (we && addr == ADDR_TX_THRESH)
+                tx_thresh <= wdata[TX_FIFO_BITS+1:0];
+
             case (tx_state)
                 TX_IDLE: begin
                     tx <= 1'b1;
-                    if (we && addr == 4'h0) begin
-                        tx_data <= wdata[7:0];
+                    if (tx_pop) begin
+                        tx_data <= tx_fifo[tx_head];
                         tx_state <= TX_START;
                         tx_busy <= 1;
                     end
                 end
-                
+
                 TX_START: begin
                     if (baud_tick) begin
                         tx <= 1'b0;  // Start bit
@@ -84,7 +219,7 @@ module uart #(
                         tx_bit_cnt <= 0;
                     end
                 end
-                
+
                 TX_DATA: begin
                     if (baud_tick) begin
                         tx <= tx_data[tx_bit_cnt];
@@ -95,7 +230,7 @@ module uart #(
                         end
                     end
                 end
-                
+
                 TX_STOP: begin
                     if (baud_tick) begin
                         tx <= 1'b1;  // Stop bit
@@ -106,15 +241,239 @@ module uart #(
             endcase
         end
     end
-    
+
+    //=================================================================
+    // TX DMA
+    //=================================================================
+    localparam D_IDLE = 2'd0;
+    localparam D_READ = 2'd1;       // Fetch the word holding the next byte
+    localparam D_PUSH = 2'd2;       // Queue its bytes
+
+    reg [1:0]  dma_state;
+    reg [31:0] dma_addr;            // Next byte to send
+    reg [31:0] dma_len;             // Bytes left
+    reg [31:0] dma_word;
+    reg        dma_irq_en;
+    reg        dma_done;
+    reg        dma_error;
+
+    wire dma_start = we && (addr == ADDR_DMA_LEN) && (dma_state == D_IDLE) &&
+                     (wdata != 0);
+
+    // One byte per cycle, when the CPU is not writing TX
+    assign dma_push  = (dma_state == D_PUSH) && !tx_full && !cpu_push;
+    assign dma_byte  = dma_word[dma_addr[1:0]*8 +: 8];
+    assign mem_valid = (dma_state == D_READ);
+    assign mem_addr  = {dma_addr[31:2], 2'b00};
+    assign irq_dma   = dma_done && dma_irq_en;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            dma_state <= D_IDLE;
+            dma_addr <= 32'h0;
+            dma_len <= 32'h0;
+            dma_word <= 32'h0;
+            dma_irq_en <= 1'b0;
+            dma_done <= 1'b0;
+            dma_error <= 1'b0;
+        end else begin
+            if (we && addr == ADDR_DMA_CTRL)
+                dma_irq_en <= wdata[0];
+            if (we && addr == ADDR_DMA_STAT && wdata[DMA_STAT_DONE])
+                dma_done <= 1'b0;
+            if (we && addr == ADDR_DMA_STAT && wdata[DMA_STAT_ERROR])
+                dma_error <= 1'b0;
+            if (we && addr == ADDR_DMA_ADDR && dma_state == D_IDLE)
+                dma_addr <= wdata;
+
+            case (dma_state)
+                D_IDLE: begin
+                    if (dma_start) begin
+                        dma_len <= wdata;
+                        dma_done <= 1'b0;
+                        dma_error <= 1'b0;
+                        dma_state <= D_READ;
+                    end
+                end
+
+                D_READ: begin
+                    if (mem_ready) begin
+                        dma_word <= mem_rdata;
+                        if (mem_error) begin
+                            dma_error <= 1'b1;
+                            dma_done <= 1'b1;
+                            dma_state <= D_IDLE;
+                        end else begin
+                            dma_state <= D_PUSH;
+                        end
+                    end
+                end
+
+                D_PUSH: begin
+                    if (dma_push) begin
+                        dma_addr <= dma_addr + 1;
+                        dma_len <= dma_len - 1;
+                        if (dma_len == 1) begin
+                            dma_done <= 1'b1;
+                            dma_state <= D_IDLE;
+                        end else if (dma_addr[1:0] == 2'b11) begin
+                            dma_state <= D_READ;
+                        end
+                    end
+                end
+
+                default: dma_state <= D_IDLE;
+            endcase
+        end
+    end
+
+    //=================================================================
+    // Receiver
+    //=================================================================
+    localparam RX_IDLE  = 2'd0;
+    localparam RX_FRAME = 2'd1;     // Start, 8 data and stop bit
+    localparam RX_BREAK = 2'd2;     // Framing error: wait for idle line
+
+    reg [2:0]  rx_sync;             // Synchroniser, rx_sync[2] is the line
+    reg [1:0]  rx_hist;             // Two previous samples
+    reg [1:0]  rx_state;
+    reg [15:0] rx_clk_cnt;          // Clocks into the current bit
+    reg [3:0]  rx_bit;              // 0 start, 1-8 data, 9 stop
+    reg [7:0]  rx_shift;
+
+    reg [7:0]              rx_fifo [0:RX_FIFO_DEPTH-1];
+    reg [RX_FIFO_BITS-1:0] rx_head;
+    reg [RX_FIFO_BITS-1:0] rx_tail;
+    reg [RX_FIFO_BITS:0]   rx_count;
+    reg [RX_FIFO_BITS:0]   rx_thresh;
+    reg                    rx_overrun;
+    reg                    rx_frame_err;
+
+    wire rx_line   = rx_sync[2];
+    // Majority of the samples one clock before, at and after the centre
+    wire rx_maj    = (rx_hist[1] & rx_hist[0]) | (rx_hist[1] & rx_line) |
+                     (rx_hist[0] & rx_line);
+    wire rx_sample = (rx_state == RX_FRAME) && (rx_clk_cnt == (baud_div >> 1) + 1);
+    wire rx_bit_end = (rx_clk_cnt >= baud_div - 1);
+
+    wire rx_empty = (rx_count == 0);
+    wire rx_full  = (rx_count == RX_FIFO_DEPTH);
+    wire rx_push  = rx_sample && (rx_bit == 9) && rx_maj && !rx_full;
+    wire rx_pop   = re && (addr == ADDR_RX_DATA) && !rx_empty;
+
+    assign irq_rx = (rx_thresh != 0) && (rx_count >= rx_thresh);
+
+    always @(posedge clk) begin
+        if (rx_push)
+            rx_fifo[rx_tail] <= rx_shift;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rx_sync <= 3'b111;
+            rx_hist <= 2'b11;
+            rx_state <= RX_IDLE;
+            rx_clk_cnt <= 0;
+            rx_bit <= 0;
+            rx_shift <= 8'h00;
+            rx_head <= 0;
+            rx_tail <= 0;
+            rx_count <= 0;
+            rx_thresh <= 1;
+            rx_overrun <= 1'b0;
+            rx_frame_err <= 1'b0;
+        end else begin
+            rx_sync <= {rx_sync[1:0], rx};
+            rx_hist <= {rx_hist[0], rx_line};
+
+            if (rx_push)
+                rx_tail <= rx_tail + 1'b1;
+            if (rx_pop)
+                rx_head <= rx_head + 1'b1;
+            rx_count <= rx_count + rx_push - rx_pop;
+
+            if (we && addr == ADDR_STATUS && wdata[STATUS_RX_OVERRUN])
+                rx_overrun <= 1'b0;
+            if (we && addr == ADDR_STATUS && wdata[STATUS_RX_FRAME_ERR])
+                rx_frame_err <= 1'b0;
+            if (we && addr == ADDR_RX_THRESH)
+                rx_thresh <= wdata[RX_FIFO_BITS:0];
+
+            case (rx_state)
+                RX_IDLE: begin
+                    // Falling edge of the start bit
+                    if (!rx_line) begin
+                        rx_state <= RX_FRAME;
+                        rx_clk_cnt <= 1;
+                        rx_bit <= 0;
+                    end
+                end
+
+                RX_FRAME: begin
+                    rx_clk_cnt <= rx_bit_end ? 16'd0 : rx_clk_cnt + 1;
+                    if (rx_bit_end)
+                        rx_bit <= rx_bit + 1;
+
+                    if (rx_sample) begin
+                        if (rx_bit == 0) begin
+                            // Glitch, not a start bit
+                            if (rx_maj)
+                                rx_state <= RX_IDLE;
+                        end else if (rx_bit <= 8) begin
+                            rx_shift <= {rx_maj, rx_shift[7:1]};  // LSB first
+                        end else begin
+                            // Stop bit: done at its centre so the next
+                            // start edge is not missed
+                            rx_state <= RX_IDLE;
+                            if (!rx_maj) begin
+                                rx_frame_err <= 1'b1;
+                                rx_state <= RX_BREAK;
+                            end else if (rx_full) begin
+                                rx_overrun <= 1'b1;
+                            end
+                        end
+                    end
+                end
+
+                RX_BREAK: begin
+                    if (rx_line)
+                        rx_state <= RX_IDLE;
+                end
+
+                default: rx_state <= RX_IDLE;
+            endcase
+        end
+    end
+
     // Read interface
     always @(*) begin
+        rdata = 32'h0;
         case (addr)
-            4'h0: rdata = {24'h0, tx_data};
-            4'h4: rdata = {31'h0, tx_busy};
-            default: rdata = 32'h0;
+            ADDR_TX:        rdata = {24'h0, tx_data};
+            ADDR_STATUS: begin
+                rdata[0]                  = tx_level != 0;
+                rdata[1]                  = tx_full;
+                rdata[2]                  = tx_level == 0;
+                rdata[STATUS_TX_OVERRUN]  = tx_overrun;
+                rdata[4]                  = !rx_empty;
+                rdata[5]                  = rx_full;
+                rdata[STATUS_RX_OVERRUN]  = rx_overrun;
+                rdata[STATUS_RX_FRAME_ERR] = rx_frame_err;
+                rdata[8 +: RX_FIFO_BITS+1] = rx_count;
+                rdata[16 +: TX_FIFO_BITS+2] = tx_level;
+            end
+            ADDR_TX_THRESH: rdata = {{(30-TX_FIFO_BITS){1'b0}}, tx_thresh};
+            ADDR_TX_SIZE:   rdata = TX_FIFO_DEPTH;
+            ADDR_RX_DATA:   rdata = {23'h0, !rx_empty, rx_empty ? 8'h00 : rx_fifo[rx_head]};
+            ADDR_BAUD_DIV:  rdata = {16'h0, baud_div};
+            ADDR_RX_THRESH: rdata = {{(31-RX_FIFO_BITS){1'b0}}, rx_thresh};
+            ADDR_RX_SIZE:   rdata = RX_FIFO_DEPTH;
+            ADDR_DMA_ADDR:  rdata = dma_addr;
+            ADDR_DMA_LEN:   rdata = dma_len;
+            ADDR_DMA_CTRL:  rdata = {31'h0, dma_irq_en};
+            ADDR_DMA_STAT:  rdata = {29'h0, dma_error, dma_done, dma_state != D_IDLE};
+            default:        rdata = 32'h0;
         endcase
     end
 
 endmodule
-
@@ -1,51 +1,151 @@
 /*
  * Anti-Replay Engine
- * 
+ *
  * Validates packet authenticity and freshness to prevent replay attacks.
  * Checks:
- *   1. Counter progression (must be > last valid counter)
+ *   1. Counter progression (must be > last valid counter, or unseen
+ *      within the sliding window in WINDOW mode)
  *   2. Nonce freshness (not in recent cache)
- *   3. HMAC verification (via crypto accelerator)
- * 
+ *   3. HMAC verification (via crypto accelerator, see packet port)
+ *
  * Features:
- * - Maintains last valid counter value
- * - Caches recent nonces (16-entry circular buffer)
+ * - Maintains last valid counter value per peer (NUM_CONTEXTS contexts)
+ * - Remembers accepted nonces in a hashed set-associative store
+ *   (CACHE_SETS x 4 ways, block RAM friendly)
  * - Validates counter + nonce combination
  * - Rejects replayed packets
- * 
+ *
+ * Contexts: CONTEXT_ID selects the peer that VALIDATE, LAST_COUNTER and
+ * CTRL.RESET_CONTEXT act on. Each context holds its own last counter
+ * and window bitmap in a context table (block RAM, read in the hash
+ * stage and written back on acceptance), so switching peers is one
+ * register write. Nonces are tagged with their context in the shared
+ * nonce store. LAST_COUNTER follows CONTEXT_ID one cycle after a write.
+ *
+ * Nonce store: the nonce is hashed to one set, whose 4 ways are read
+ * in one cycle from a single-port memory and compared in parallel. An
+ * accepted nonce fills a free way of its set, or evicts the oldest one
+ * (round-robin per set). A check takes 4 cycles after VALIDATE; STATUS
+ * READY is low until the result is valid. Evicted nonces are forgotten,
+ * so the store covers at least the last CACHE_SETS accepted nonces and
+ * typically close to CACHE_SETS * 4.
+ *
+ * Sliding window (RFC 4303 style, CTRL.WINDOW): LAST_COUNTER is the
+ * highest accepted counter. A counter above it is accepted and advances
+ * the window; a counter up to WINDOW_BITS-1 behind it is accepted once,
+ * tracked in a WINDOW_BITS bitmap. Older counters are rejected. The
+ * bitmap is circular (bit = counter mod WINDOW_BITS), so advancing only
+ * clears the bits the window slides over - a jump of any size is one
+ * cycle. With CTRL.NONCE_OFF the nonce store is bypassed and the window
+ * alone decides. Without WINDOW the counter must strictly increase.
+ *
+ * Batch mode: (context, counter, nonce) tuples written to REQ_PUSH, one
+ * word each in that order, queue in a BATCH_DEPTH request FIFO. The
+ * engine drains it back to back (one check every 3 cycles) and queues
+ * one result word per tuple in the result FIFO, read through
+ * RESULT_POP. Both registers suit a DMA transfer with a fixed address
+ * (a descriptor array in data RAM in, a result array out). A full
+ * result FIFO pauses the batch: no tuple is checked (or committed)
+ * until its result has room, so OVERFLOW only flags REQ_PUSH writes
+ * to a full request FIFO. A single VALIDATE goes ahead of queued
+ * tuples and reports through STATUS as before. irq pulses when a
+ * single check completes and when the request FIFO has been drained.
+ *
+ * RESULT word: [3:0] STATUS bits 0-3 of the check, [8] PRESENT (0 when
+ * the FIFO was empty), [9] BAD_CONTEXT (context >= NUM_CONTEXTS: not
+ * checked or committed, STATUS bits 0), [23:16] context.
+ *
+ * Packet port: the crypto accelerator's packet mode holds pkt_req with
+ * (context, counter, nonce) of a packet whose tag it has verified. The
+ * check is scheduled after a single VALIDATE and before batch tuples,
+ * and commits like any other; pkt_done pulses with its STATUS bits 0-3.
+ * It does not touch STATUS or raise irq. A context >= NUM_CONTEXTS is
+ * refused (STATUS bits 0) without a commit; the crypto accelerator
+ * already rejects such descriptors as BAD_DESC.
+ *
  * Memory Map (base + offset):
  *   0x00: LAST_COUNTER    - Last valid counter value (R)
  *   0x04: CHECK_COUNTER   - Counter to validate (W)
  *   0x08: CHECK_NONCE     - Nonce to validate (W)
- *   0x0C: VALIDATE        - Trigger validation (W)
+ *   0x0C: VALIDATE        - Trigger validation (W, ignored while busy)
  *   0x10: STATUS          - Validation result (R)
- *   0x14: CACHE_SIZE      - Number of cached nonces (R)
- *   0x18: CTRL            - Control register (W)
+ *   0x14: CACHE_SIZE      - Number of nonces currently stored (R)
+ *   0x18: CTRL            - Control register (R/W)
+ *   0x1C: CACHE_CAPACITY  - Nonce store size in entries (R)
+ *   0x20: WINDOW_SIZE     - Sliding window size in counters (R)
+ *   0x24: CONTEXT_ID      - Selected peer context (R/W)
+ *   0x28: NUM_CONTEXTS    - Number of contexts (R)
+ *   0x2C: REQ_PUSH        - Batch request words (W)
+ *   0x30: RESULT_POP      - Oldest batch result, read pops (R)
+ *   0x34: BATCH_STATUS    - [7:0] queued requests, [15:8] queued results,
+ *                           [16] BUSY, [17] OVERFLOW (write 1 to clear) (R/W)
+ *
+ * CTRL bits:
+ *   0: RESET_CACHE - Empty the nonce store (action)
+ *   1: RESET_STATE - All contexts: LAST_COUNTER = 0, clear window and
+ *                    status (action)
+ *   2: WINDOW      - Sliding window counter check (mode)
+ *   3: NONCE_OFF   - Skip the nonce store (mode)
+ *   4: RESET_CONTEXT - As RESET_STATE for the selected context only (action)
+ *   5: FLUSH       - Empty both batch FIFOs, clear OVERFLOW (action)
+ *
+ * STATUS BAD_COUNTER: counter not above LAST_COUNTER, or (WINDOW mode)
+ * older than the window or already seen within it.
+ *
+ * Interrupt: irq pulses for one cycle when a validation completes.
  */
 
 `timescale 1ns / 1ps
 
-module anti_replay (
+module anti_replay #(
+    parameter CACHE_SETS  = 64,     // 64-1024 (256-4096 nonces)
+    parameter SET_BITS    = 6,      // log2(CACHE_SETS)
+    parameter WINDOW_BITS = 64,     // 64-1024 counters
+    parameter WINDOW_IDX  = 6,      // log2(WINDOW_BITS)
+    parameter NUM_CONTEXTS = 32,    // Peer contexts
+    parameter CTX_BITS     = 5,     // log2(NUM_CONTEXTS)
+    parameter BATCH_DEPTH  = 32,    // Request / result FIFO entries
+    parameter BATCH_BITS   = 5      // log2(BATCH_DEPTH)
+)(
     input  wire        clk,
     input  wire        rst_n,
-    
+
     // CPU Interface (memory-mapped)
-    input  wire [4:0]  addr,        // Register address (byte offset / 4)
+    input  wire [6:0]  addr,        // Register address (byte offset)
     input  wire        we,          // Write enable
+    input  wire        re,          // Read strobe (pops RESULT_POP)
     input  wire [31:0] wdata,       // Write data
-    output reg  [31:0] rdata        // Read data
+    output reg  [31:0] rdata,       // Read data
+
+    // Packet check from the crypto accelerator (req held until done)
+    input  wire        pkt_req,
+    input  wire [7:0]  pkt_ctx,
+    input  wire [31:0] pkt_counter,
+    input  wire [31:0] pkt_nonce,
+    output reg         pkt_done,
+    output reg  [3:0]  pkt_status,
+
+    // Interrupt request (validation complete)
+    output reg         irq
 );
 
     //=================================================================
     // Register Map
     //=================================================================
-    localparam ADDR_LAST_COUNTER  = 5'h00;
-    localparam ADDR_CHECK_COUNTER = 5'h04;
-    localparam ADDR_CHECK_NONCE   = 5'h08;
-    localparam ADDR_VALIDATE      = 5'h0C;
-    localparam ADDR_STATUS        = 5'h10;
-    localparam ADDR_CACHE_SIZE    = 5'h14;
-    localparam ADDR_CTRL          = 5'h18;
+    localparam ADDR_LAST_COUNTER   = 7'h00;
+    localparam ADDR_CHECK_COUNTER  = 7'h04;
+    localparam ADDR_CHECK_NONCE    = 7'h08;
+    localparam ADDR_VALIDATE       = 7'h0C;
+    localparam ADDR_STATUS         = 7'h10;
+    localparam ADDR_CACHE_SIZE     = 7'h14;
+    localparam ADDR_CTRL           = 7'h18;
+    localparam ADDR_CACHE_CAPACITY = 7'h1C;
+    localparam ADDR_WINDOW_SIZE    = 7'h20;
+    localparam ADDR_CONTEXT_ID     = 7'h24;
+    localparam ADDR_NUM_CONTEXTS   = 7'h28;
+    localparam ADDR_REQ_PUSH       = 7'h2C;
+    localparam ADDR_RESULT_POP     = 7'h30;
+    localparam ADDR_BATCH_STATUS   = 7'h34;
 
     //=================================================================
     // Status Bits
@@ -61,149 +161,438 @@ module anti_replay (
     //=================================================================
     localparam CTRL_RESET_CACHE = 0;
     localparam CTRL_RESET_STATE = 1;
+    localparam CTRL_WINDOW      = 2;
+    localparam CTRL_NONCE_OFF   = 3;
+    localparam CTRL_RESET_CONTEXT = 4;
+    localparam CTRL_FLUSH       = 5;
+
+    //=================================================================
+    // Nonce Store Configuration
+    //=================================================================
+    localparam CACHE_WAYS     = 4;
+    localparam CACHE_CAPACITY = CACHE_SETS * CACHE_WAYS;
+    localparam NONCE_TAG      = CTX_BITS + 32;      // {context, nonce}
+    localparam SET_WIDTH      = 2 + CACHE_WAYS + CACHE_WAYS * NONCE_TAG;
+
+    // Set word: {victim[1:0], way valid[3:0], tag way3 .. way0}
+    localparam SET_VALID_LSB  = CACHE_WAYS * NONCE_TAG;
+    localparam SET_VICTIM_LSB = SET_VALID_LSB + CACHE_WAYS;
 
     //=================================================================
-    // Nonce Cache Configuration
+    // Check Pipeline
     //=================================================================
-    localparam CACHE_SIZE = 16;  // Number of recent nonces to track
-    localparam CACHE_BITS = 4;   // log2(CACHE_SIZE)
+    localparam S_IDLE  = 2'd0;
+    localparam S_HASH  = 2'd1;     // Hash nonce to a set index, read context
+    localparam S_READ  = 2'd2;     // Read the set
+    localparam S_CHECK = 2'd3;     // Compare ways, update store and state
 
     //=================================================================
     // Internal Registers
     //=================================================================
-    reg [31:0] last_counter;
     reg [31:0] check_counter;
     reg [31:0] check_nonce;
     reg [31:0] status_reg;
     reg        ready;
-    
-    // Nonce cache (circular buffer)
-    reg [31:0] nonce_cache [0:CACHE_SIZE-1];
-    reg [CACHE_BITS-1:0] cache_head;
-    reg [CACHE_BITS-1:0] cache_count;
-
-    //=================================================================
-    // Validation Logic
-    //=================================================================
-    reg  validate_trigger;
-    wire counter_valid;
-    wire nonce_fresh;
-    wire validation_passed;
-    
-    // Counter must be greater than last valid counter
-    assign counter_valid = (check_counter > last_counter);
-    
-    // Nonce must not be in cache
-    reg nonce_found;
+    reg [1:0]  state;
+    reg [3:2]  mode_reg;            // CTRL WINDOW / NONCE_OFF
+    reg [CTX_BITS-1:0] context_id;
+
+    // Single check latched at VALIDATE (CHECK_* may be rewritten meanwhile)
+    reg        single_pending;
+    reg [31:0] sgl_counter;
+    reg [31:0] sgl_nonce;
+    reg [CTX_BITS-1:0] sgl_ctx;
+
+    // Check in the pipeline
+    reg        chk_batch;
+    reg        chk_pkt;
+    reg        pkt_busy;            // Packet check in the pipeline
+    reg [31:0] chk_counter;
+    reg [31:0] chk_nonce;
+    reg [CTX_BITS-1:0] chk_ctx;
+    reg                chk_bad_ctx;     // Context out of range: no commit
+    reg [SET_BITS-1:0] chk_set;
+
+    // Batch FIFOs (request: {bad context, context, counter, nonce},
+    // result: {bad context, context, status})
+    localparam REQ_WIDTH = 1 + CTX_BITS + 64;
+    localparam RES_WIDTH = 1 + CTX_BITS + 4;
+
+    reg [REQ_WIDTH-1:0]  req_fifo [0:BATCH_DEPTH-1];
+    reg [BATCH_BITS-1:0] req_head;
+    reg [BATCH_BITS-1:0] req_tail;
+    reg [BATCH_BITS:0]   req_count;
+    reg [RES_WIDTH-1:0]  res_fifo [0:BATCH_DEPTH-1];
+    reg [BATCH_BITS-1:0] res_head;
+    reg [BATCH_BITS-1:0] res_tail;
+    reg [BATCH_BITS:0]   res_count;
+    reg [1:0]            push_phase;
+    reg [CTX_BITS-1:0]   push_ctx;
+    reg                  push_bad_ctx;
+    reg [31:0]           push_counter;
+    reg                  batch_overflow;
+
+    // Context table: {last counter, window bitmap} per peer (no reset: a
+    // context reads as LAST_COUNTER 0 with counter 0 seen until ctx_live)
+    localparam CTX_WIDTH = 32 + WINDOW_BITS;
+
+    reg [CTX_WIDTH-1:0]    ctx_mem [0:NUM_CONTEXTS-1];
+    reg [CTX_WIDTH-1:0]    ctx_rd;
+    reg                    ctx_rd_live;
+    reg [NUM_CONTEXTS-1:0] ctx_live;
+
+    // Idle: follow CONTEXT_ID for LAST_COUNTER; busy: the context being checked
+    wire [CTX_BITS-1:0] ctx_sel = (state == S_IDLE) ? context_id : chk_ctx;
+
+    // Selected context: seen counters are bit (counter mod WINDOW_BITS)
+    wire [31:0]            last_counter = ctx_rd_live ? ctx_rd[WINDOW_BITS +: 32] : 32'h0;
+    wire [WINDOW_BITS-1:0] window       = ctx_rd_live ? ctx_rd[WINDOW_BITS-1:0] :
+                                          {{(WINDOW_BITS-1){1'b0}}, 1'b1};
+
+    // Nonce store (no reset: a set is empty until set_live is set)
+    reg [SET_WIDTH-1:0]  set_mem [0:CACHE_SETS-1];
+    reg [SET_WIDTH-1:0]  set_rd;
+    reg [CACHE_SETS-1:0] set_live;
+    reg [12:0]           cache_count;
+
     integer i;
+
+    //=================================================================
+    // Hash (multiplicative, top bits select the set)
+    //=================================================================
+    wire [NONCE_TAG-1:0] chk_tag    = {chk_ctx, chk_nonce};
+    wire [31:0]          nonce_hash = (chk_nonce ^ {chk_ctx, {(32-CTX_BITS){1'b0}}}) * 32'h9E3779B1;
+
+    //=================================================================
+    // Validation Logic (S_CHECK)
+    //=================================================================
+    wire [CACHE_WAYS-1:0] way_valid = set_live[chk_set] ?
+                                      set_rd[SET_VALID_LSB +: CACHE_WAYS] :
+                                      {CACHE_WAYS{1'b0}};
+    wire [1:0]            victim    = set_live[chk_set] ? set_rd[SET_VICTIM_LSB +: 2] : 2'd0;
+
+    // Nonce must not be in its set
+    reg       nonce_found;
+    reg       way_free;
+    reg [1:0] free_way;
     always @(*) begin
-        nonce_found = 0;
-        for (i = 0; i < CACHE_SIZE; i = i + 1) begin
-            if (i < cache_count && nonce_cache[i] == check_nonce) begin
-                nonce_found = 1;
+        nonce_found = 1'b0;
+        way_free    = 1'b0;
+        free_way    = 2'd0;
+        for (i = CACHE_WAYS - 1; i >= 0; i = i - 1) begin
+            if (way_valid[i] && set_rd[i*NONCE_TAG +: NONCE_TAG] == chk_tag)
+                nonce_found = 1'b1;
+            if (!way_valid[i]) begin
+                way_free = 1'b1;
+                free_way = i;
             end
         end
     end
-    assign nonce_fresh = !nonce_found;
-    
-    // Overall validation
-    assign validation_passed = counter_valid && nonce_fresh;
+
+    // Counter position relative to the highest accepted counter
+    wire        ahead      = (chk_counter > last_counter);
+    wire [31:0] distance   = ahead ? chk_counter - last_counter : last_counter - chk_counter;
+    wire [WINDOW_IDX-1:0] chk_bit = chk_counter[WINDOW_IDX-1:0];
+    wire        in_window  = !ahead && (distance < WINDOW_BITS) && !window[chk_bit];
+
+    // Counter must be greater than last valid counter (or unseen in the window)
+    wire counter_valid     = ahead || (mode_reg[CTRL_WINDOW] && in_window);
+    wire nonce_fresh       = !nonce_found || mode_reg[CTRL_NONCE_OFF];
+    wire validation_passed = !chk_bad_ctx && counter_valid && nonce_fresh;
+    wire nonce_insert      = validation_passed && !mode_reg[CTRL_NONCE_OFF];
+
+    // STATUS bits 0-3 for this check
+    wire [3:0] check_status = chk_bad_ctx ? 4'h0 :
+                              {!nonce_fresh, !counter_valid,
+                               !validation_passed, validation_passed};
+
+    //=================================================================
+    // Scheduling (a new check can follow S_CHECK directly)
+    //=================================================================
+    wire start_ok     = (state == S_IDLE) || (state == S_CHECK);
+    wire start_single = start_ok && single_pending;
+    // pkt_req is still high in the pkt_done cycle (the accelerator drops
+    // it on seeing done), so a finished packet is not taken again
+    wire start_pkt    = start_ok && !single_pending && pkt_req && !pkt_busy && !pkt_done;
+    // A batch check starts only with room for its result, counting the
+    // one in the pipeline
+    wire res_room     = (res_count + (state != S_IDLE && chk_batch)) < BATCH_DEPTH;
+    wire start_batch  = start_ok && !single_pending && !start_pkt && (req_count != 0) && res_room;
+    wire [REQ_WIDTH-1:0] req_head_data = req_fifo[req_head];
+
+    // FIFO updates
+    wire req_push = we && (addr == ADDR_REQ_PUSH) && (push_phase == 2'd2) &&
+                    (req_count != BATCH_DEPTH);
+    wire res_push = (state == S_CHECK) && chk_batch && (res_count != BATCH_DEPTH);
+    wire res_pop  = re && (addr == ADDR_RESULT_POP) && (res_count != 0);
+
+    // Window after accepting chk_counter: advancing clears the bits of the
+    // counters skipped over (offset 1..distance past the old top)
+    wire [WINDOW_IDX-1:0] top_bit = last_counter[WINDOW_IDX-1:0];
+    reg  [WINDOW_BITS-1:0] window_next;
+    reg  [WINDOW_IDX-1:0]  slide;
+    integer b;
+    always @(*) begin
+        for (b = 0; b < WINDOW_BITS; b = b + 1) begin
+            slide = b - top_bit - 1;
+            if (ahead && (distance >= WINDOW_BITS || slide < distance))
+                window_next[b] = 1'b0;
+            else
+                window_next[b] = window[b];
+        end
+        window_next[chk_bit] = 1'b1;
+    end
+
+    // Set contents after inserting chk_nonce
+    wire [1:0] insert_way = way_free ? free_way : victim;
+    reg  [SET_WIDTH-1:0] set_wr;
+    always @(*) begin
+        set_wr = set_rd;
+        set_wr[SET_VALID_LSB +: CACHE_WAYS] = way_valid;
+        set_wr[SET_VICTIM_LSB +: 2]         = way_free ? victim : victim + 2'd1;
+        set_wr[insert_way*NONCE_TAG +: NONCE_TAG] = chk_tag;
+        set_wr[SET_VALID_LSB + insert_way]  = 1'b1;
+    end
+
+    //=================================================================
+    // Nonce Store Memory (synchronous read, single port)
+    //=================================================================
+    always @(posedge clk) begin
+        if (state == S_READ)
+            set_rd <= set_mem[chk_set];
+        if (state == S_CHECK && nonce_insert)
+            set_mem[chk_set] <= set_wr;
+    end
+
+    //=================================================================
+    // Context Table Memory (synchronous read, written on acceptance)
+    //=================================================================
+    always @(posedge clk) begin
+        ctx_rd      <= ctx_mem[ctx_sel];
+        ctx_rd_live <= ctx_live[ctx_sel];
+        if (state == S_CHECK && validation_passed)
+            ctx_mem[chk_ctx] <= {ahead ? chk_counter : last_counter, window_next};
+    end
 
     //=================================================================
     // State Machine
     //=================================================================
+    always @(posedge clk) begin
+        if (req_push)
+            req_fifo[req_tail] <= {push_bad_ctx, push_ctx, push_counter, wdata};
+        if (res_push)
+            res_fifo[res_tail] <= {chk_bad_ctx, chk_ctx, check_status};
+    end
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            last_counter     <= 32'h0;
             check_counter    <= 32'h0;
             check_nonce      <= 32'h0;
             status_reg       <= 32'h0;
             ready            <= 1'b1;
-            cache_head       <= 0;
-            cache_count      <= 0;
-            validate_trigger <= 1'b0;
-            
-            // Clear nonce cache
-            for (i = 0; i < CACHE_SIZE; i = i + 1) begin
-                nonce_cache[i] <= 32'h0;
-            end
-            
+            state            <= S_IDLE;
+            mode_reg         <= 2'b00;
+            context_id       <= {CTX_BITS{1'b0}};
+            ctx_live         <= {NUM_CONTEXTS{1'b0}};
+            single_pending   <= 1'b0;
+            sgl_counter      <= 32'h0;
+            sgl_nonce        <= 32'h0;
+            sgl_ctx          <= {CTX_BITS{1'b0}};
+            chk_batch        <= 1'b0;
+            chk_pkt          <= 1'b0;
+            pkt_busy         <= 1'b0;
+            pkt_done         <= 1'b0;
+            pkt_status       <= 4'h0;
+            chk_counter      <= 32'h0;
+            chk_nonce        <= 32'h0;
+            chk_ctx          <= {CTX_BITS{1'b0}};
+            chk_bad_ctx      <= 1'b0;
+            req_head         <= {BATCH_BITS{1'b0}};
+            req_tail         <= {BATCH_BITS{1'b0}};
+            req_count        <= {(BATCH_BITS+1){1'b0}};
+            res_head         <= {BATCH_BITS{1'b0}};
+            res_tail         <= {BATCH_BITS{1'b0}};
+            res_count        <= {(BATCH_BITS+1){1'b0}};
+            push_phase       <= 2'd0;
+            push_ctx         <= {CTX_BITS{1'b0}};
+            push_bad_ctx     <= 1'b0;
+            push_counter     <= 32'h0;
+            batch_overflow   <= 1'b0;
+            chk_set          <= {SET_BITS{1'b0}};
+            set_live         <= {CACHE_SETS{1'b0}};
+            cache_count      <= 13'h0;
+            irq              <= 1'b0;
         end else begin
-            // Default: ready is high
-            ready <= 1'b1;
-            
+            irq <= 1'b0;
+            pkt_done <= 1'b0;
+
+            //---------------------------------------------------------
+            // Check pipeline
+            //---------------------------------------------------------
+            case (state)
+                S_HASH: begin
+                    chk_set <= nonce_hash[31 -: SET_BITS];
+                    state   <= S_READ;
+                end
+
+                S_READ: begin
+                    state <= S_CHECK;
+                end
+
+                S_CHECK: begin
+                    // Report: STATUS for a single check, result FIFO for a
+                    // batch, the packet port for a packet
+                    if (chk_pkt) begin
+                        pkt_done   <= 1'b1;
+                        pkt_status <= check_status;
+                        pkt_busy   <= 1'b0;
+                    end else if (!chk_batch) begin
+                        status_reg[3:0] <= check_status;
+                        ready <= 1'b1;
+                        irq   <= 1'b1;
+                    end else if (req_count == 0) begin
+                        irq   <= 1'b1;
+                    end
+
+                    // If validation passed, update state
+                    if (validation_passed) begin
+                        // Update last valid counter and mark it seen
+                        // (context written back by the memory block)
+                        ctx_live[chk_ctx] <= 1'b1;
+
+                        // Add nonce to its set (written by the memory block)
+                        if (nonce_insert) begin
+                            set_live[chk_set] <= 1'b1;
+                            if (way_free)
+                                cache_count <= cache_count + 1;
+                        end
+                    end
+
+                    state <= S_IDLE;
+                end
+
+                default: ;
+            endcase
+
+            // Start the next check: a single VALIDATE goes first
+            if (start_single) begin
+                single_pending <= 1'b0;
+                chk_batch      <= 1'b0;
+                chk_pkt        <= 1'b0;
+                chk_counter    <= sgl_counter;
+                chk_nonce      <= sgl_nonce;
+                chk_ctx        <= sgl_ctx;
+                chk_bad_ctx    <= 1'b0;
+                state          <= S_HASH;
+            end else if (start_pkt) begin
+                pkt_busy       <= 1'b1;
+                chk_batch      <= 1'b0;
+                chk_pkt        <= 1'b1;
+                chk_counter    <= pkt_counter;
+                chk_nonce      <= pkt_nonce;
+                chk_ctx        <= pkt_ctx[CTX_BITS-1:0];
+                chk_bad_ctx    <= (pkt_ctx >= NUM_CONTEXTS);
+                state          <= S_HASH;
+            end else if (start_batch) begin
+                chk_batch      <= 1'b1;
+                chk_pkt        <= 1'b0;
+                {chk_bad_ctx, chk_ctx, chk_counter, chk_nonce} <= req_head_data;
+                req_head       <= req_head + 1'b1;
+                state          <= S_HASH;
+            end
+
+            //---------------------------------------------------------
+            // Batch FIFO pointers
+            //---------------------------------------------------------
+            if (req_push)
+                req_tail <= req_tail + 1'b1;
+            req_count <= req_count + req_push - start_batch;
+
+            if (res_push)
+                res_tail <= res_tail + 1'b1;
+            if (res_pop)
+                res_head <= res_head + 1'b1;
+            res_count <= res_count + res_push - res_pop;
+
+            //---------------------------------------------------------
             // Handle writes
+            //---------------------------------------------------------
             if (we) begin
                 case (addr)
                     ADDR_CHECK_COUNTER: begin
                         check_counter <= wdata;
                     end
-                    
+
                     ADDR_CHECK_NONCE: begin
                         check_nonce <= wdata;
                     end
-                    
+
                     ADDR_VALIDATE: begin
-                        // Trigger validation immediately
+                        // Queue a single check (one at a time)
                         if (ready) begin
-                            ready <= 1'b0;
-                            
-                            // Clear previous status
-                            status_reg <= 32'h0;
-                            
-                            // Check counter
-                            if (!counter_valid) begin
-                                status_reg[STATUS_BAD_COUNTER] <= 1'b1;
-                                status_reg[STATUS_REPLAY] <= 1'b1;
-                            end
-                            
-                            // Check nonce
-                            if (!nonce_fresh) begin
-                                status_reg[STATUS_BAD_NONCE] <= 1'b1;
-                                status_reg[STATUS_REPLAY] <= 1'b1;
-                            end
-                            
-                            // If validation passed, update state
-                            if (validation_passed) begin
-                                status_reg[STATUS_VALID] <= 1'b1;
-                                
-                                // Update last valid counter
-                                last_counter <= check_counter;
-                                
-                                // Add nonce to cache
-                                nonce_cache[cache_head] <= check_nonce;
-                                if (cache_head == (CACHE_SIZE - 1)) begin
-                                    cache_head <= 0;
-                                end else begin
-                                    cache_head <= cache_head + 1;
-                                end
-                                
-                                if (cache_count < CACHE_SIZE) begin
-                                    cache_count <= cache_count + 1;
-                                end
-                            end
-                            
-                            // Validation complete, set ready
-                            ready <= 1'b1;
+                            ready          <= 1'b0;
+                            status_reg     <= 32'h0;
+                            single_pending <= 1'b1;
+                            sgl_counter    <= check_counter;
+                            sgl_nonce      <= check_nonce;
+                            sgl_ctx        <= context_id;
                         end
                     end
-                    
+
+                    ADDR_REQ_PUSH: begin
+                        // Word order: context, counter, nonce
+                        case (push_phase)
+                            2'd0: begin
+                                push_ctx     <= wdata[CTX_BITS-1:0];
+                                push_bad_ctx <= (wdata >= NUM_CONTEXTS);
+                            end
+                            2'd1: push_counter <= wdata;
+                            default: if (!req_push) batch_overflow <= 1'b1;
+                        endcase
+                        push_phase <= (push_phase == 2'd2) ? 2'd0 : push_phase + 1'b1;
+                    end
+
+                    ADDR_BATCH_STATUS: begin
+                        if (wdata[17])
+                            batch_overflow <= 1'b0;
+                    end
+
+                    ADDR_CONTEXT_ID: begin
+                        context_id <= wdata[CTX_BITS-1:0];
+                    end
+
                     ADDR_CTRL: begin
-                        // Reset nonce cache
+                        mode_reg <= wdata[3:2];
+
+                        // Reset nonce store (wins over an insert in flight)
                         if (wdata[CTRL_RESET_CACHE]) begin
-                            cache_head <= 0;
-                            cache_count <= 0;
-                            for (i = 0; i < CACHE_SIZE; i = i + 1) begin
-                                nonce_cache[i] <= 32'h0;
-                            end
+                            set_live    <= {CACHE_SETS{1'b0}};
+                            cache_count <= 13'h0;
+                        end
+
+                        // Empty the batch FIFOs (a check in flight still reports)
+                        if (wdata[CTRL_FLUSH]) begin
+                            req_head       <= {BATCH_BITS{1'b0}};
+                            req_tail       <= {BATCH_BITS{1'b0}};
+                            req_count      <= {(BATCH_BITS+1){1'b0}};
+                            res_head       <= {BATCH_BITS{1'b0}};
+                            res_tail       <= {BATCH_BITS{1'b0}};
+                            res_count      <= {(BATCH_BITS+1){1'b0}};
+                            push_phase     <= 2'd0;
+                            batch_overflow <= 1'b0;
                         end
-                        
-                        // Reset state
+
+                        // Reset state (all contexts, or the selected one)
                         if (wdata[CTRL_RESET_STATE]) begin
-                            last_counter <= 32'h0;
+                            ctx_live <= {NUM_CONTEXTS{1'b0}};
+                            status_reg <= 32'h0;
+                        end else if (wdata[CTRL_RESET_CONTEXT]) begin
+                            ctx_live[context_id] <= 1'b0;
                             status_reg <= 32'h0;
                         end
                     end
+
+                    default: ;
                 endcase
             end
         end
@@ -214,16 +603,25 @@ module anti_replay (
     //=================================================================
     always @(*) begin
         case (addr)
-            ADDR_LAST_COUNTER:  rdata = last_counter;
-            ADDR_STATUS:        rdata = {27'h0, ready, status_reg[3:0]};
-            ADDR_CACHE_SIZE:    rdata = {28'h0, cache_count};
-            default:            rdata = 32'h0;
+            ADDR_LAST_COUNTER:   rdata = last_counter;
+            ADDR_STATUS:         rdata = {27'h0, ready, status_reg[3:0]};
+            ADDR_CACHE_SIZE:     rdata = {19'h0, cache_count};
+            ADDR_CTRL:           rdata = {28'h0, mode_reg, 2'b00};
+            ADDR_CACHE_CAPACITY: rdata = CACHE_CAPACITY;
+            ADDR_WINDOW_SIZE:    rdata = WINDOW_BITS;
+            ADDR_CONTEXT_ID:     rdata = context_id;
+            ADDR_NUM_CONTEXTS:   rdata = NUM_CONTEXTS;
+            ADDR_RESULT_POP:     rdata = (res_count != 0) ?
+                                         {8'h0, {(8-CTX_BITS){1'b0}}, res_fifo[res_head][RES_WIDTH-2:4],
+                                          6'h0, res_fifo[res_head][RES_WIDTH-1], 1'b1,
+                                          4'h0, res_fifo[res_head][3:0]} :
+                                         32'h0;
+            ADDR_BATCH_STATUS:   rdata = {14'h0, batch_overflow,
+                                          (req_count != 0) || (state != S_IDLE && chk_batch),
+                                          {(7-BATCH_BITS){1'b0}}, res_count,
+                                          {(7-BATCH_BITS){1'b0}}, req_count};
+            default:             rdata = 32'h0;
         endcase
     end
 
 endmodule
-
-
-
-
-
@@ -1,12 +1,14 @@
 /*
  * Crypto Accelerator - Memory-Mapped Peripheral
- * 
+ *
  * Provides CPU interface to cryptographic operations:
- * - SHA-256 hashing
+ * - SHA-256 hashing (MODE_SHA256: digest of MSG_LEN bytes at MSG_ADDR,
+ *   key unused)
  * - HMAC-SHA256 authentication
- * 
+ * - Authenticated packet check (HMAC tag + anti-replay, fused)
+ *
  * Base Address: 0x30000000
- * 
+ *
  * Register Map:
  *   0x00: CTRL       - Control register
  *   0x04: STATUS     - Status register
@@ -15,25 +17,74 @@
  *   0x10: MSG_LEN    - Message length
  *   0x14-0x30: KEY   - Key registers (8 x 32-bit)
  *   0x40-0x5C: HASH  - Output hash (8 x 32-bit)
+ *   0x60: PKT_ADDR    - Packet buffer address (word aligned)
+ *   0x64: PKT_LEN     - Packet length in bytes
+ *   0x68: PKT_TAG_OFF - Offset of the 32-byte tag; the HMAC covers
+ *                       bytes 0 .. PKT_TAG_OFF-1
+ *   0x6C: PKT_FIELDS  - [15:0] counter offset, [31:16] nonce offset
+ *   0x70: PKT_CONTEXT - Anti-replay context of the sender
+ *   0x74: PKT_RESULT  - Result of the last packet check (R)
+ *
+ * Byte order: KEY and HASH hold the key and digest as byte strings in
+ * memory order (KEY_0 = key bytes 0-3 as a little-endian word), so a
+ * digest compares directly with a signature or tag stored in memory.
+ *
+ * Packet mode (MODE = PACKET, then CTRL.START): the engine computes the
+ * HMAC of the packet up to the tag, compares it with the tag, and only
+ * if it matches submits (PKT_CONTEXT, counter, nonce) to the anti-replay
+ * engine, which checks and commits freshness in one step. An
+ * unauthenticated packet never advances LAST_COUNTER or fills the nonce
+ * store. The counter and nonce are 32-bit little-endian fields inside
+ * the authenticated bytes. STATUS DONE (and irq) is set once per packet.
+ *
+ * Streaming (SHA256 / HMAC modes): a message can be hashed in chunks as
+ * it arrives. CTRL.START with MORE absorbs MSG_LEN bytes (a multiple of
+ * 64) at MSG_ADDR and sets DONE without touching HASH; START with
+ * CONTINUE appends the next chunk to the open message instead of
+ * starting a new one. The last chunk (CONTINUE without MORE, any
+ * length including 0) writes the digest of the whole message to HASH.
+ * STATUS STREAM is set while a message is open. CONTINUE without an
+ * open message, MORE with a partial block, or either in packet mode
+ * sets ERROR; any other operation closes an open message.
+ *
+ * PKT_RESULT bits:
+ *   3:0: Anti-replay STATUS bits 0-3 (VALID, REPLAY, BAD_COUNTER,
+ *        BAD_NONCE); VALID means the packet is accepted
+ *   4:   BAD_TAG  - HMAC mismatch, freshness not checked
+ *   5:   BAD_DESC - Misaligned or out-of-range descriptor, or a
+ *          PKT_CONTEXT without an anti-replay context (STATUS ERROR)
  */
 
 `timescale 1ns / 1ps
 
-module crypto_accelerator (
+module crypto_accelerator #(
+    parameter REPLAY_CONTEXTS = 32  // Anti-replay NUM_CONTEXTS
+)(
     input  wire        clk,
     input  wire        rst_n,
-    
+
     // CPU Interface (memory-mapped)
     input  wire [7:0]  addr,           // Register address (byte offset / 4)
     input  wire        we,             // Write enable
     input  wire [31:0] wdata,          // Write data
     output reg  [31:0] rdata,          // Read data
-    
-    // Memory Interface (for HMAC to read firmware)
+
+    // Memory Interface (for HMAC to read firmware and packets)
     output wire [31:0] mem_addr,
     output wire        mem_valid,
     input  wire [31:0] mem_rdata,
-    input  wire        mem_ready
+    input  wire        mem_ready,
+
+    // Anti-replay check (packet mode; req held until done)
+    output reg         replay_req,
+    output reg  [7:0]  replay_ctx,
+    output reg  [31:0] replay_counter,
+    output reg  [31:0] replay_nonce,
+    input  wire        replay_done,
+    input  wire [3:0]  replay_status,
+
+    // Interrupt request (operation done)
+    output wire        irq
 );
 
     //=================================================================
@@ -46,19 +97,32 @@ module crypto_accelerator (
     localparam ADDR_MSG_LEN  = 8'h10;
     localparam ADDR_KEY_BASE = 8'h14;  // 0x14-0x30 (8 words)
     localparam ADDR_HASH_BASE = 8'h40; // 0x40-0x5C (8 words)
+    localparam ADDR_PKT_ADDR    = 8'h60;
+    localparam ADDR_PKT_LEN     = 8'h64;
+    localparam ADDR_PKT_TAG_OFF = 8'h68;
+    localparam ADDR_PKT_FIELDS  = 8'h6C;
+    localparam ADDR_PKT_CONTEXT = 8'h70;
+    localparam ADDR_PKT_RESULT  = 8'h74;
 
     //=================================================================
     // Control/Status Bits
     //=================================================================
     localparam CTRL_START = 0;
     localparam CTRL_RESET = 1;
-    
-    localparam STATUS_BUSY  = 0;
-    localparam STATUS_DONE  = 1;
-    localparam STATUS_ERROR = 2;
-    
+    localparam CTRL_CONTINUE = 2;   // Append to the open message
+    localparam CTRL_MORE     = 3;   // More chunks follow
+
+    localparam STATUS_BUSY   = 0;
+    localparam STATUS_DONE   = 1;
+    localparam STATUS_ERROR  = 2;
+    localparam STATUS_STREAM = 3;   // Streamed message open
+
     localparam MODE_SHA256      = 2'b00;
     localparam MODE_HMAC_SHA256 = 2'b01;
+    localparam MODE_PACKET      = 2'b10;
+
+    localparam RESULT_BAD_TAG  = 4;
+    localparam RESULT_BAD_DESC = 5;
 
     //=================================================================
     // Registers
@@ -70,29 +134,64 @@ module crypto_accelerator (
     reg [31:0] msg_len_reg;
     reg [31:0] key_reg [0:7];
     reg [31:0] hash_reg [0:7];
+    reg [31:0] pkt_addr_reg;
+    reg [31:0] pkt_len_reg;
+    reg [31:0] pkt_tag_off_reg;
+    reg [31:0] pkt_fields_reg;
+    reg [7:0]  pkt_ctx_reg;
+    reg [5:0]  pkt_result;
+
+    // START / RESET requests (set by a CTRL write, cleared when taken)
+    wire start_req = ctrl_reg[CTRL_START];
+    wire reset_req = ctrl_reg[CTRL_RESET];
+
+    // Streamed chunk flags of the pending START
+    wire start_cont = ctrl_reg[CTRL_CONTINUE];
+    wire start_more = ctrl_reg[CTRL_MORE];
 
     //=================================================================
     // HMAC Instance
     //=================================================================
     reg         hmac_start;
+    reg         hmac_cont;
+    reg         hmac_more;
     wire [255:0] hmac_key;
     wire [255:0] hmac_mac;
     wire        hmac_ready;
     wire        hmac_done;
-    
+    wire [31:0] hmac_msg_addr;
+    wire [31:0] hmac_msg_len;
+    wire [31:0] hmac_mem_addr;
+    wire        hmac_mem_valid;
+
+    // Little-endian bus word <-> big-endian byte string
+    function [31:0] bswap;
+        input [31:0] w;
+        bswap = {w[7:0], w[15:8], w[23:16], w[31:24]};
+    endfunction
+
     // Pack key registers into 256-bit vector
-    assign hmac_key = {key_reg[0], key_reg[1], key_reg[2], key_reg[3],
-                      key_reg[4], key_reg[5], key_reg[6], key_reg[7]};
-    
+    assign hmac_key = {bswap(key_reg[0]), bswap(key_reg[1]),
+                       bswap(key_reg[2]), bswap(key_reg[3]),
+                       bswap(key_reg[4]), bswap(key_reg[5]),
+                       bswap(key_reg[6]), bswap(key_reg[7])};
+
+    wire packet_mode = (mode_reg[1:0] == MODE_PACKET);
+    assign hmac_msg_addr = packet_mode ? pkt_addr_reg    : msg_addr_reg;
+    assign hmac_msg_len  = packet_mode ? pkt_tag_off_reg : msg_len_reg;
+
     hmac_sha256 hmac_inst (
         .clk(clk),
         .rst_n(rst_n),
         .start(hmac_start),
+        .hash_only(mode_reg[1:0] == MODE_SHA256),
+        .cont(hmac_cont),
+        .more(hmac_more),
         .key(hmac_key),
-        .msg_addr(msg_addr_reg),
-        .msg_len(msg_len_reg),
-        .mem_addr(mem_addr),
-        .mem_valid(mem_valid),
+        .msg_addr(hmac_msg_addr),
+        .msg_len(hmac_msg_len),
+        .mem_addr(hmac_mem_addr),
+        .mem_valid(hmac_mem_valid),
         .mem_rdata(mem_rdata),
         .mem_ready(mem_ready),
         .mac_out(hmac_mac),
@@ -100,15 +199,57 @@ module crypto_accelerator (
         .done(hmac_done)
     );
 
+    //=================================================================
+    // Packet Check (tag and field fetch after the HMAC)
+    //=================================================================
+    localparam P_IDLE   = 3'd0;
+    localparam P_HMAC   = 3'd1;     // HMAC over bytes 0 .. TAG_OFF-1
+    localparam P_FETCH  = 3'd2;     // Read tag words 0-7, counter, nonce
+    localparam P_REPLAY = 3'd3;     // Wait for the anti-replay result
+
+    reg [2:0]  pkt_state;
+    reg [3:0]  fetch_idx;
+    reg        fetch_valid;
+    reg        tag_ok;
+
+    wire [15:0] ctr_off   = pkt_fields_reg[15:0];
+    wire [15:0] nonce_off = pkt_fields_reg[31:16];
+    wire [31:0] fetch_off = (fetch_idx == 4'd8) ? {16'h0, ctr_off} :
+                            (fetch_idx == 4'd9) ? {16'h0, nonce_off} :
+                            pkt_tag_off_reg + {fetch_idx, 2'b00};
+
+    // The tag is the digest in byte order (tag word n = HASH_n)
+    wire [31:0] mac_word = bswap(hmac_mac[255 - fetch_idx[2:0]*32 -: 32]);
+
+    // Tag and fields in the packet, fields covered by the HMAC, and a
+    // context the anti-replay engine has
+    wire desc_ok = (pkt_ctx_reg < REPLAY_CONTEXTS) &&
+                   (pkt_addr_reg[1:0] == 2'b00) && (pkt_tag_off_reg[1:0] == 2'b00) &&
+                   (ctr_off[1:0] == 2'b00) && (nonce_off[1:0] == 2'b00) &&
+                   (pkt_tag_off_reg <= pkt_len_reg - 32) && (pkt_len_reg >= 32) &&
+                   ({16'h0, ctr_off} + 4 <= pkt_tag_off_reg) &&
+                   ({16'h0, nonce_off} + 4 <= pkt_tag_off_reg);
+
+    assign mem_valid = hmac_mem_valid || fetch_valid;
+    assign mem_addr  = fetch_valid ? pkt_addr_reg + fetch_off : hmac_mem_addr;
+
     //=================================================================
     // Control Logic
     //=================================================================
     reg operation_active;
-    
+    reg stream_open;                // Streamed message in the HMAC engine
+
+    // DONE stays set until the next START/RESET; the interrupt
+    // controller latches its rising edge
+    assign irq = status_reg[STATUS_DONE];
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             operation_active <= 1'b0;
             hmac_start <= 1'b0;
+            hmac_cont <= 1'b0;
+            hmac_more <= 1'b0;
+            stream_open <= 1'b0;
             status_reg <= 32'h0;
             ctrl_reg <= 32'h0;
             hash_reg[0] <= 32'h0;
@@ -119,48 +260,165 @@ module crypto_accelerator (
             hash_reg[5] <= 32'h0;
             hash_reg[6] <= 32'h0;
             hash_reg[7] <= 32'h0;
-            
+            pkt_state <= P_IDLE;
+            pkt_result <= 6'h0;
+            fetch_idx <= 4'd0;
+            fetch_valid <= 1'b0;
+            tag_ok <= 1'b0;
+            replay_req <= 1'b0;
+            replay_ctx <= 8'h0;
+            replay_counter <= 32'h0;
+            replay_nonce <= 32'h0;
+
         end else begin
             // Default: clear one-shot signals
             hmac_start <= 1'b0;
-            
+
+            // Latch CTRL writes (START/RESET are taken below)
+            if (we && addr == 8'h00)
+                ctrl_reg <= wdata;
+
             // Handle START command
-            if (ctrl_reg[CTRL_START] && !operation_active) begin
+            if (start_req && !operation_active && pkt_state == P_IDLE) begin
                 operation_active <= 1'b1;
                 status_reg[STATUS_BUSY] <= 1'b1;
                 status_reg[STATUS_DONE] <= 1'b0;
-                
+                status_reg[STATUS_ERROR] <= 1'b0;
+
                 // Start appropriate operation based on mode
-                if (mode_reg[1:0] == MODE_HMAC_SHA256) begin
+                if ((start_cont && !stream_open) ||
+                    (start_more && msg_len_reg[5:0] != 6'd0) ||
+                    ((start_cont || start_more) && packet_mode)) begin
+                    // Bad streamed chunk: the open message is dropped
+                    operation_active <= 1'b0;
+                    stream_open <= 1'b0;
+                    status_reg[STATUS_BUSY] <= 1'b0;
+                    status_reg[STATUS_DONE] <= 1'b1;
+                    status_reg[STATUS_ERROR] <= 1'b1;
+                end else if (mode_reg[1:0] == MODE_HMAC_SHA256 || mode_reg[1:0] == MODE_SHA256) begin
                     hmac_start <= 1'b1;
+                    hmac_cont <= start_cont;
+                    hmac_more <= start_more;
+                    stream_open <= start_more;
+                end else if (packet_mode) begin
+                    pkt_result <= 6'h0;
+                    stream_open <= 1'b0;
+                    hmac_cont <= 1'b0;
+                    hmac_more <= 1'b0;
+                    if (desc_ok) begin
+                        hmac_start <= 1'b1;
+                        pkt_state <= P_HMAC;
+                    end else begin
+                        // Nothing is read or committed
+                        operation_active <= 1'b0;
+                        pkt_result[RESULT_BAD_DESC] <= 1'b1;
+                        status_reg[STATUS_BUSY] <= 1'b0;
+                        status_reg[STATUS_DONE] <= 1'b1;
+                        status_reg[STATUS_ERROR] <= 1'b1;
+                    end
+                end else begin
+                    // Unknown mode
+                    operation_active <= 1'b0;
+                    stream_open <= 1'b0;
+                    status_reg[STATUS_BUSY] <= 1'b0;
+                    status_reg[STATUS_DONE] <= 1'b1;
+                    status_reg[STATUS_ERROR] <= 1'b1;
                 end
-                
+
                 // Clear start bit
                 ctrl_reg[CTRL_START] <= 1'b0;
             end
-            
+
             // Check for completion
-            if (operation_active && hmac_done) begin
+            if (operation_active && hmac_done && hmac_more) begin
+                // Chunk absorbed, no result until the last chunk
                 operation_active <= 1'b0;
                 status_reg[STATUS_BUSY] <= 1'b0;
                 status_reg[STATUS_DONE] <= 1'b1;
-                
+            end else if (operation_active && hmac_done) begin
                 // Store result
-                hash_reg[0] <= hmac_mac[255:224];
-                hash_reg[1] <= hmac_mac[223:192];
-                hash_reg[2] <= hmac_mac[191:160];
-                hash_reg[3] <= hmac_mac[159:128];
-                hash_reg[4] <= hmac_mac[127:96];
-                hash_reg[5] <= hmac_mac[95:64];
-                hash_reg[6] <= hmac_mac[63:32];
-                hash_reg[7] <= hmac_mac[31:0];
+                hash_reg[0] <= bswap(hmac_mac[255:224]);
+                hash_reg[1] <= bswap(hmac_mac[223:192]);
+                hash_reg[2] <= bswap(hmac_mac[191:160]);
+                hash_reg[3] <= bswap(hmac_mac[159:128]);
+                hash_reg[4] <= bswap(hmac_mac[127:96]);
+                hash_reg[5] <= bswap(hmac_mac[95:64]);
+                hash_reg[6] <= bswap(hmac_mac[63:32]);
+                hash_reg[7] <= bswap(hmac_mac[31:0]);
+
+                if (pkt_state == P_HMAC) begin
+                    // Packet: compare the tag next
+                    pkt_state <= P_FETCH;
+                    fetch_idx <= 4'd0;
+                    fetch_valid <= 1'b1;
+                    tag_ok <= 1'b1;
+                end else begin
+                    operation_active <= 1'b0;
+                    status_reg[STATUS_BUSY] <= 1'b0;
+                    status_reg[STATUS_DONE] <= 1'b1;
+                end
             end
-            
-            // Handle RESET
-            if (ctrl_reg[CTRL_RESET]) begin
+
+            //---------------------------------------------------------
+            // Packet: tag compare, then the anti-replay commit
+            //---------------------------------------------------------
+            case (pkt_state)
+                P_FETCH: begin
+                    // Hold each read until the bus arbiter grants it
+                    if (mem_ready) begin
+                        if (fetch_idx < 4'd8) begin
+                            if (mem_rdata != mac_word)
+                                tag_ok <= 1'b0;
+                        end else if (fetch_idx == 4'd8) begin
+                            replay_counter <= mem_rdata;
+                        end else begin
+                            replay_nonce <= mem_rdata;
+                        end
+
+                        if (fetch_idx == 4'd9) begin
+                            fetch_valid <= 1'b0;
+                            if (tag_ok) begin
+                                replay_req <= 1'b1;
+                                replay_ctx <= pkt_ctx_reg;
+                                pkt_state <= P_REPLAY;
+                            end else begin
+                                pkt_result[RESULT_BAD_TAG] <= 1'b1;
+                                pkt_state <= P_IDLE;
+                                operation_active <= 1'b0;
+                                status_reg[STATUS_BUSY] <= 1'b0;
+                                status_reg[STATUS_DONE] <= 1'b1;
+                            end
+                        end else begin
+                            fetch_idx <= fetch_idx + 1'b1;
+                        end
+                    end
+                end
+
+                P_REPLAY: begin
+                    if (replay_done) begin
+                        replay_req <= 1'b0;
+                        pkt_result[3:0] <= replay_status;
+                        pkt_state <= P_IDLE;
+                        operation_active <= 1'b0;
+                        status_reg[STATUS_BUSY] <= 1'b0;
+                        status_reg[STATUS_DONE] <= 1'b1;
+                    end
+                end
+
+                default: ;
+            endcase
+
+            // Handle RESET (a check already submitted still commits)
+            if (reset_req) begin
                 operation_active <= 1'b0;
+                stream_open <= 1'b0;
                 status_reg <= 32'h0;
                 ctrl_reg[CTRL_RESET] <= 1'b0;
+                fetch_valid <= 1'b0;
+                if (pkt_state != P_REPLAY || replay_done) begin
+                    replay_req <= 1'b0;
+                    pkt_state <= P_IDLE;
+                end
             end
         end
     end
@@ -177,25 +435,28 @@ module crypto_accelerator (
             for (i = 0; i < 8; i = i + 1) begin
                 key_reg[i] <= 32'h0;
             end
-            
+            pkt_addr_reg <= 32'h0;
+            pkt_len_reg <= 32'h0;
+            pkt_tag_off_reg <= 32'h0;
+            pkt_fields_reg <= 32'h0;
+            pkt_ctx_reg <= 8'h0;
+
         end else if (we) begin
             case (addr)
-                8'h00: begin  // ADDR_CTRL (0x30000000 / 4)
-                    ctrl_reg <= wdata;
-                end
-                
+                // ADDR_CTRL (word 0x00) is latched by the control logic
+
                 8'h02: begin  // ADDR_MODE (0x30000008 / 4)
                     mode_reg <= wdata;
                 end
-                
+
                 8'h03: begin  // ADDR_MSG_ADDR (0x3000000C / 4)
                     msg_addr_reg <= wdata;
                 end
-                
+
                 8'h04: begin  // ADDR_MSG_LEN (0x30000010 / 4)
                     msg_len_reg <= wdata;
                 end
-                
+
                 // Key registers (byte offsets 0x14-0x30, word addresses 0x05-0x0C)
                 // mem_addr[9:2] for 0x30000014 = (0x14 >> 2) = 0x05
                 8'h05: key_reg[0] <= wdata;  // 0x30000014 / 4 = 0x05
@@ -206,7 +467,14 @@ module crypto_accelerator (
                 8'h0A: key_reg[5] <= wdata;  // 0x30000028 / 4 = 0x0A
                 8'h0B: key_reg[6] <= wdata;  // 0x3000002C / 4 = 0x0B
                 8'h0C: key_reg[7] <= wdata;  // 0x30000030 / 4 = 0x0C
-                
+
+                // Packet descriptor (byte offsets 0x60-0x70)
+                8'h18: pkt_addr_reg    <= wdata;         // 0x30000060 / 4
+                8'h19: pkt_len_reg     <= wdata;         // 0x30000064 / 4
+                8'h1A: pkt_tag_off_reg <= wdata;         // 0x30000068 / 4
+                8'h1B: pkt_fields_reg  <= wdata;         // 0x3000006C / 4
+                8'h1C: pkt_ctx_reg     <= wdata[7:0];    // 0x30000070 / 4
+
                 default: begin
                     // Read-only or invalid address
                 end
@@ -220,11 +488,11 @@ module crypto_accelerator (
     always @(*) begin
         case (addr)
             8'h00: rdata = ctrl_reg;      // ADDR_CTRL (0x30000000 / 4)
-            8'h01: rdata = status_reg;    // ADDR_STATUS (0x30000004 / 4)
+            8'h01: rdata = status_reg | {28'h0, stream_open, 3'b000};  // ADDR_STATUS
             8'h02: rdata = mode_reg;      // ADDR_MODE (0x30000008 / 4)
             8'h03: rdata = msg_addr_reg;  // ADDR_MSG_ADDR (0x3000000C / 4)
             8'h04: rdata = msg_len_reg;   // ADDR_MSG_LEN (0x30000010 / 4)
-            
+
             // Key registers (word addresses: byte offset / 4)
             8'h05: rdata = key_reg[0];  // 0x30000014 / 4
             8'h06: rdata = key_reg[1];  // 0x30000018 / 4
@@ -234,7 +502,7 @@ module crypto_accelerator (
             8'h0A: rdata = key_reg[5];  // 0x30000028 / 4
             8'h0B: rdata = key_reg[6];  // 0x3000002C / 4
             8'h0C: rdata = key_reg[7];  // 0x30000030 / 4
-            
+
             // Hash output registers (word addresses: byte offset / 4)
             8'h10: rdata = hash_reg[0]; // 0x30000040 / 4
             8'h11: rdata = hash_reg[1]; // 0x30000044 / 4
@@ -244,10 +512,17 @@ module crypto_accelerator (
             8'h15: rdata = hash_reg[5]; // 0x30000054 / 4
             8'h16: rdata = hash_reg[6]; // 0x30000058 / 4
             8'h17: rdata = hash_reg[7]; // 0x3000005C / 4
-            
+
+            // Packet descriptor and result
+            8'h18: rdata = pkt_addr_reg;            // 0x30000060 / 4
+            8'h19: rdata = pkt_len_reg;             // 0x30000064 / 4
+            8'h1A: rdata = pkt_tag_off_reg;         // 0x30000068 / 4
+            8'h1B: rdata = pkt_fields_reg;          // 0x3000006C / 4
+            8'h1C: rdata = {24'h0, pkt_ctx_reg};    // 0x30000070 / 4
+            8'h1D: rdata = {26'h0, pkt_result};     // 0x30000074 / 4
+
             default: rdata = 32'h0;
         endcase
     end
 
 endmodule
-
@@ -1,12 +1,30 @@
 /*
  * HMAC-SHA256 Module
- * 
+ *
  * Implements HMAC (Hash-based Message Authentication Code) using SHA-256
  * HMAC = H((K ⊕ opad) || H((K ⊕ ipad) || message))
- * 
+ *
  * Simplified version for firmware verification:
  * - Assumes key is exactly 256 bits (32 bytes)
  * - Message read from memory via bus interface
+ *
+ * Byte order: key and mac_out are big-endian byte strings (byte 0 in
+ * bits [255:248]). The message is read as little-endian bus words, so
+ * byte n of the message is the byte at msg_addr + n. msg_addr must be
+ * word aligned; msg_len is any number of bytes.
+ *
+ * Message words are collected while the previous block is hashed; a
+ * full block waits only if the SHA core is still busy.
+ *
+ * With hash_only set at start the key is not used and mac_out is the
+ * plain SHA-256 of the message (no ipad block, no outer hash).
+ *
+ * Streaming: a message can be fed in chunks. A start with more set
+ * absorbs msg_len bytes (a multiple of 64) and signals done without a
+ * result; a start with cont set continues that message instead of
+ * starting a new one (hash_only and key are taken from its first
+ * chunk). The last chunk (cont, not more) may be any length, including
+ * 0, and produces mac_out over all chunks.
  */
 
 `timescale 1ns / 1ps
@@ -14,19 +32,22 @@
 module hmac_sha256 (
     input  wire         clk,
     input  wire         rst_n,
-    
+
     // Control
     input  wire         start,          // Start HMAC calculation
+    input  wire         hash_only,      // Plain SHA-256 (sampled at start)
+    input  wire         cont,           // Continue the streamed message
+    input  wire         more,           // More chunks follow (no result yet)
     input  wire [255:0] key,            // 256-bit key
     input  wire [31:0]  msg_addr,       // Message start address
     input  wire [31:0]  msg_len,        // Message length in bytes
-    
+
     // Memory interface for reading message
     output reg  [31:0]  mem_addr,
     output reg          mem_valid,
     input  wire [31:0]  mem_rdata,
     input  wire         mem_ready,
-    
+
     // Output
     output reg  [255:0] mac_out,        // HMAC output
     output reg          ready,          // Ready for next operation
@@ -52,8 +73,14 @@ module hmac_sha256 (
     localparam HASH_OUTER   = 4'b0111;
     localparam FINISH_OUTER = 4'b1000;
     localparam COMPLETE     = 4'b1001;
-    
+    localparam SEND_BLOCK   = 4'b1010;
+    localparam FINISH_LEN   = 4'b1011;
+
     reg [3:0] state;
+    reg        plain;                   // hash_only for this operation
+    reg        cont_op;                 // cont for this operation
+    reg        more_op;                 // more for this operation
+    reg [31:0] stream_bytes;            // Bytes absorbed by earlier chunks
     reg [31:0] byte_count;
     reg [31:0] block_count;
 
@@ -65,7 +92,7 @@ module hmac_sha256 (
     reg [511:0] sha_block;
     wire [255:0] sha_hash;
     wire        sha_ready;
-    
+
     sha256 sha_inst (
         .clk(clk),
         .rst_n(rst_n),
@@ -76,13 +103,18 @@ module hmac_sha256 (
         .ready(sha_ready)
     );
 
+    // The core only drops ready the cycle after init/next_block, and it
+    // reads block_in until it is done: sha_block may only change (and a
+    // new command be issued) while sha_idle is set
+    wire sha_idle = sha_ready && !sha_next && !sha_init;
+
     //=================================================================
     // Key Padding (K ⊕ ipad and K ⊕ opad)
     //=================================================================
     reg [511:0] key_ipad;  // K ⊕ 0x36 (padded to 512 bits)
     reg [511:0] key_opad;  // K ⊕ 0x5C (padded to 512 bits)
     reg [255:0] inner_hash;
-    
+
     integer i;
     always @(*) begin
         // Prepare ipad block: (K ⊕ 0x36363636...) || padding
@@ -103,153 +135,214 @@ module hmac_sha256 (
     reg [511:0] msg_block;
     reg [9:0]   msg_block_bytes;  // Bytes in current block (0-64)
 
+    // Bus word in message byte order, bytes past msg_len cleared
+    wire [31:0] msg_left   = msg_len - byte_count;
+    wire [2:0]  word_bytes = (msg_left >= 4) ? 3'd4 : msg_left[2:0];
+    wire [31:0] word_be    = {mem_rdata[7:0], mem_rdata[15:8],
+                              mem_rdata[23:16], mem_rdata[31:24]};
+    wire [31:0] word_mask  = ~(32'hFFFFFFFF >> (word_bytes * 8));
+    wire [31:0] word_msg   = word_be & word_mask;
+
+    // Last block(s): 0x80 after the message, then the length in bits
+    // (the ipad block counts as 64 message bytes)
+    wire [511:0] pad_block  = msg_block | ({8'h80, 504'h0} >> (msg_block_bytes * 8));
+    wire [63:0]  total_bits = {29'h0, stream_bytes + msg_len + (plain ? 32'd0 : 32'd64), 3'b000};
+
     //=================================================================
     // Main State Machine
     //=================================================================
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             state <= IDLE;
+            plain <= 1'b0;
+            cont_op <= 1'b0;
+            more_op <= 1'b0;
+            stream_bytes <= 32'h0;
             ready <= 1'b1;
             done <= 1'b0;
             sha_init <= 1'b0;
             sha_next <= 1'b0;
+            sha_block <= 512'h0;
             mem_valid <= 1'b0;
+            mem_addr <= 32'h0;
             byte_count <= 0;
             block_count <= 0;
+            msg_block <= 512'h0;
+            msg_block_bytes <= 0;
+            inner_hash <= 256'h0;
             mac_out <= 256'h0;
-            
+
         end else begin
             // Default: deassert control signals
             sha_init <= 1'b0;
             sha_next <= 1'b0;
             mem_valid <= 1'b0;
-            
+
             case (state)
                 IDLE: begin
                     ready <= 1'b1;
                     done <= 1'b0;
-                    
+
                     if (start) begin
                         ready <= 1'b0;
-                        state <= PREP_INNER;
+                        cont_op <= cont;
+                        more_op <= more;
+                        if (!cont) begin
+                            plain <= hash_only;
+                            stream_bytes <= 32'h0;
+                        end
+                        // A continued chunk keeps the SHA state
+                        state <= cont ? HASH_INNER : PREP_INNER;
                         byte_count <= 0;
                         block_count <= 0;
+                        msg_block <= 512'h0;
                         msg_block_bytes <= 0;
                     end
                 end
-                
+
                 //==========================================================
                 // INNER HASH: H((K ⊕ ipad) || message)
                 //==========================================================
                 PREP_INNER: begin
-                    // Initialize SHA-256 for inner hash
-                    sha_init <= 1'b1;
-                    state <= HASH_INNER;
+                    if (sha_idle) begin
+                        // Initialize SHA-256 for inner hash
+                        sha_init <= 1'b1;
+                        state <= HASH_INNER;
+                    end
                 end
-                
+
                 HASH_INNER: begin
-                    if (sha_ready) begin
+                    if (sha_idle) begin
                         // Hash the (K ⊕ ipad) block first
-                        sha_block <= key_ipad;
-                        sha_next <= 1'b1;
+                        if (!plain && !cont_op) begin
+                            sha_block <= key_ipad;
+                            sha_next <= 1'b1;
+                        end
                         state <= READ_MSG;
                         mem_addr <= msg_addr;
                     end
                 end
-                
+
                 READ_MSG: begin
-                    if (sha_ready) begin
-                        if (byte_count < msg_len) begin
-                            // Read next word from memory
-                            mem_valid <= 1'b1;
-                            state <= WAIT_MSG;
-                        end else begin
-                            // Message complete, finalize with padding
-                            state <= FINISH_INNER;
-                        end
+                    if (byte_count < msg_len) begin
+                        // Read next word from memory
+                        mem_valid <= 1'b1;
+                        state <= WAIT_MSG;
+                    end else if (more_op) begin
+                        // Chunk absorbed, more follow: no padding yet
+                        stream_bytes <= stream_bytes + msg_len;
+                        done <= 1'b1;
+                        state <= IDLE;
+                    end else begin
+                        // Message complete, finalize with padding
+                        state <= FINISH_INNER;
                     end
                 end
-                
+
                 WAIT_MSG: begin
-                    if (mem_ready) begin
+                    // Hold the request until the bus arbiter grants it
+                    if (!mem_ready) begin
+                        mem_valid <= 1'b1;
+                    end else begin
                         // Store word in message block
-                        msg_block[511 - msg_block_bytes*8 -: 32] <= mem_rdata;
-                        msg_block_bytes <= msg_block_bytes + 4;
-                        byte_count <= byte_count + 4;
+                        msg_block[511 - msg_block_bytes*8 -: 32] <= word_msg;
+                        msg_block_bytes <= msg_block_bytes + word_bytes;
+                        byte_count <= byte_count + word_bytes;
                         mem_addr <= mem_addr + 4;
-                        
-                        if (msg_block_bytes == 60) begin
+
+                        if (msg_block_bytes + word_bytes == 64) begin
                             // Block full, hash it
-                            sha_block <= msg_block;
-                            sha_next <= 1'b1;
-                            msg_block_bytes <= 0;
-                            state <= READ_MSG;
+                            state <= SEND_BLOCK;
                         end else begin
                             state <= READ_MSG;
                         end
                     end
                 end
-                
-                FINISH_INNER: begin
-                    if (sha_ready) begin
-                        // Add SHA-256 padding: 0x80 || zeros || length
-                        // Simplified: assume message fits in remaining block space
-                        msg_block[511 - msg_block_bytes*8 -: 8] <= 8'h80;
-                        
-                        // Add length in bits at end (last 64 bits)
-                        // Total length = 64 bytes (ipad block) + msg_len
-                        msg_block[63:0] <= {32'h0, ((32'd64 + msg_len) << 3)};
-                        
+
+                SEND_BLOCK: begin
+                    if (sha_idle) begin
                         sha_block <= msg_block;
                         sha_next <= 1'b1;
+                        msg_block <= 512'h0;
+                        msg_block_bytes <= 0;
+                        block_count <= block_count + 1;
+                        state <= READ_MSG;
+                    end
+                end
+
+                FINISH_INNER: begin
+                    if (sha_idle) begin
+                        // SHA-256 padding: 0x80 || zeros || length. The
+                        // length needs the last 8 bytes of a block; with
+                        // 56 or more message bytes it goes in an extra one.
+                        sha_next <= 1'b1;
+                        if (msg_block_bytes < 56) begin
+                            sha_block <= {pad_block[511:64], total_bits};
+                            state <= PREP_OUTER;
+                        end else begin
+                            sha_block <= pad_block;
+                            state <= FINISH_LEN;
+                        end
+                    end
+                end
+
+                FINISH_LEN: begin
+                    if (sha_idle) begin
+                        sha_block <= {448'h0, total_bits};
+                        sha_next <= 1'b1;
                         state <= PREP_OUTER;
                     end
                 end
-                
+
                 //==========================================================
                 // OUTER HASH: H((K ⊕ opad) || inner_hash)
                 //==========================================================
                 PREP_OUTER: begin
-                    if (sha_ready) begin
+                    if (sha_idle && plain) begin
+                        // Plain SHA-256: the inner hash is the result
+                        mac_out <= sha_hash;
+                        done <= 1'b1;
+                        state <= IDLE;
+                    end else if (sha_idle) begin
                         // Save inner hash
                         inner_hash <= sha_hash;
-                        
+
                         // Initialize for outer hash
                         sha_init <= 1'b1;
                         state <= HASH_OUTER;
                     end
                 end
-                
+
                 HASH_OUTER: begin
-                    if (sha_ready) begin
+                    if (sha_idle) begin
                         // Hash (K ⊕ opad) block
                         sha_block <= key_opad;
                         sha_next <= 1'b1;
                         state <= FINISH_OUTER;
                     end
                 end
-                
+
                 FINISH_OUTER: begin
-                    if (sha_ready) begin
+                    if (sha_idle) begin
                         // Hash inner_hash with padding
                         sha_block[511:256] <= inner_hash;
                         sha_block[255:248] <= 8'h80;  // Padding
                         sha_block[247:64] <= 184'h0;  // Zeros
                         sha_block[63:0] <= 64'd768;   // Length: (64 + 32) * 8 = 768 bits
-                        
+
                         sha_next <= 1'b1;
                         state <= COMPLETE;
                     end
                 end
-                
+
                 COMPLETE: begin
-                    if (sha_ready) begin
+                    if (sha_idle) begin
                         mac_out <= sha_hash;
                         done <= 1'b1;
                         state <= IDLE;
                     end
                 end
-                
+
                 default: begin
                     state <= IDLE;
                 end
@@ -258,4 +351,3 @@ module hmac_sha256 (
     end
 
 endmodule
-
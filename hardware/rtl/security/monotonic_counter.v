@@ -1,31 +1,71 @@
 /*
  * Monotonic Counter Module
- * 
+ *
  * Hardware counter that only increments, never decrements.
  * Used for anti-replay protection to ensure packet freshness.
- * 
+ *
  * Features:
- * - 32-bit counter (0 to 4,294,967,295)
+ * - 32- or 64-bit counter (COUNTER_WIDTH)
  * - Increment-only (cannot decrement or reset to lower value)
  * - Lock mechanism (freeze counter after boot/provisioning)
  * - Overflow protection (saturates at maximum value)
- * 
+ * - Atomic fetch-and-increment and block reservation in one load
+ *
+ * Sequence numbers: INC_AND_READ increments and returns the new value.
+ * RESERVE advances by RESERVE_N and returns the first value of the
+ * block (the counter then holds the last one), so a sender can number
+ * a burst of packets with one load. Both are single bus reads, so
+ * harts and other masters never get the same value. A read that would
+ * pass the maximum (or hits a locked counter) returns 0, leaves the
+ * counter unchanged and, on overflow, sets STATUS OVERFLOW (RESERVE_N
+ * 0 also returns 0).
+ *
+ * 64-bit values: a read of COUNTER, INC_AND_READ or RESERVE captures
+ * bits 63:32 of the value it returns in COUNTER_HI. A direct COUNTER
+ * write takes bits 63:32 from COUNTER_HI (write it first).
+ *
+ * Firmware version floor (anti-rollback): a separate 32-bit register
+ * that only moves up. A write of a version to VERSION_CHECK checks it
+ * against the floor and, if it is not lower, raises the floor to it,
+ * in one cycle; reading VERSION_CHECK returns the result (bit 0 OK).
+ * The boot ROM does this with the verified header version, then locks
+ * the floor (VERSION_LOCK) so the firmware can neither advance nor
+ * test it. The floor is cleared only by power-on reset, standing in
+ * for the fuses or NV counter real silicon would use; the lock is
+ * cleared by any reset, so every boot runs the check again.
+ *
  * Memory Map (base + offset):
  *   0x00: COUNTER      - Current counter value (R/W)
  *   0x04: CTRL         - Control register (W)
  *   0x08: LOCK         - Lock register (W, write 0xDEADLOCK to lock)
  *   0x0C: STATUS       - Status register (R)
+ *   0x10: INC_AND_READ - Increment, return the new value (R)
+ *   0x14: RESERVE      - Advance by RESERVE_N, return the first value (R)
+ *   0x18: RESERVE_N    - Block size for RESERVE (R/W, reset 1)
+ *   0x1C: COUNTER_HI   - Bits 63:32 of the last value read (R/W)
+ *   0x20: VERSION_FLOOR - Lowest bootable firmware version (R)
+ *   0x24: VERSION_CHECK - Write: check and advance; read: bit 0 OK
+ *   0x28: VERSION_LOCK  - Write LOCK_MAGIC to lock the floor
+ *
+ * STATUS bits: 0 LOCKED, 1 OVERFLOW, 2 VERSION_LOCKED
+ *
+ * (soc_top maps 0x10-0x1C at base + 0x80-0x8C and 0x20-0x28 at
+ * base + 0x90-0x98, after the nonce generator and anti-replay engine.)
  */
 
 `timescale 1ns / 1ps
 
-module monotonic_counter (
+module monotonic_counter #(
+    parameter COUNTER_WIDTH = 32        // 32 or 64
+)(
     input  wire        clk,
     input  wire        rst_n,
-    
+    input  wire        por_n,       // Power-on reset (version floor)
+
     // CPU Interface (memory-mapped)
-    input  wire [3:0]  addr,        // Register address (byte offset / 4)
+    input  wire [5:0]  addr,        // Register address (byte offset)
     input  wire        we,          // Write enable
+    input  wire        re,          // Read strobe (INC_AND_READ, RESERVE)
     input  wire [31:0] wdata,       // Write data
     output reg  [31:0] rdata        // Read data
 );
@@ -33,75 +73,159 @@ module monotonic_counter (
     //=================================================================
     // Register Map
     //=================================================================
-    localparam ADDR_COUNTER = 4'h0;
-    localparam ADDR_CTRL    = 4'h4;
-    localparam ADDR_LOCK    = 4'h8;
-    localparam ADDR_STATUS  = 4'hC;
+    localparam ADDR_COUNTER      = 6'h00;
+    localparam ADDR_CTRL         = 6'h04;
+    localparam ADDR_LOCK         = 6'h08;
+    localparam ADDR_STATUS       = 6'h0C;
+    localparam ADDR_INC_AND_READ = 6'h10;
+    localparam ADDR_RESERVE      = 6'h14;
+    localparam ADDR_RESERVE_N    = 6'h18;
+    localparam ADDR_COUNTER_HI   = 6'h1C;
+    localparam ADDR_VER_FLOOR    = 6'h20;
+    localparam ADDR_VER_CHECK    = 6'h24;
+    localparam ADDR_VER_LOCK     = 6'h28;
 
     //=================================================================
     // Control Bits
     //=================================================================
     localparam CTRL_INCREMENT = 0;
     localparam CTRL_LOAD      = 1;
-    
+
     localparam STATUS_LOCKED   = 0;
     localparam STATUS_OVERFLOW = 1;
+    localparam STATUS_VER_LOCKED = 2;
 
     //=================================================================
     // Lock Magic Value
     //=================================================================
     localparam LOCK_MAGIC = 32'hDEAD10CC;
 
+    localparam [COUNTER_WIDTH-1:0] COUNTER_MAX = {COUNTER_WIDTH{1'b1}};
+
     //=================================================================
     // Internal Registers
     //=================================================================
-    reg [31:0] counter;
+    reg [COUNTER_WIDTH-1:0] counter;
     reg        locked;
     reg        overflow;
+    reg [31:0] reserve_n;
+    reg [31:0] counter_hi;
+    reg [31:0] ver_floor;
+    reg        ver_locked;
+    reg        ver_ok;              // Result of the last VERSION_CHECK
+
+    //=================================================================
+    // Fetch-and-add (combinational, taken on the read strobe)
+    //=================================================================
+    wire                     fetch     = (addr == ADDR_INC_AND_READ) || (addr == ADDR_RESERVE);
+    wire [COUNTER_WIDTH-1:0] fetch_n   = (addr == ADDR_RESERVE) ? reserve_n : 1;
+    wire                     fetch_ok  = !locked && (fetch_n != 0) &&
+                                         (fetch_n <= COUNTER_MAX - counter);
+    wire [COUNTER_WIDTH-1:0] fetch_val = fetch_ok ? counter + 1 : {COUNTER_WIDTH{1'b0}};
+    wire                     fetch_re  = re && fetch;
+
+    // Bits 63:32 of a value (0 for a 32-bit counter)
+    function [31:0] high_word;
+        input [COUNTER_WIDTH-1:0] v;
+        high_word = (COUNTER_WIDTH > 32) ? v >> 32 : 32'h0;
+    endfunction
+
+    // Direct write value (high word from COUNTER_HI)
+    wire [63:0]              load_64  = {counter_hi, wdata};
+    wire [COUNTER_WIDTH-1:0] load_val = load_64[COUNTER_WIDTH-1:0];
 
     //=================================================================
     // Counter Logic
     //=================================================================
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            counter  <= 32'h0;
-            locked   <= 1'b0;
-            overflow <= 1'b0;
-            
-        end else if (!locked && we) begin
-            case (addr)
-                ADDR_CTRL: begin
-                    // Increment counter
-                    if (wdata[CTRL_INCREMENT]) begin
-                        if (counter == 32'hFFFFFFFF) begin
-                            overflow <= 1'b1;  // Saturate at max
-                        end else begin
-                            counter <= counter + 1;
+            counter    <= {COUNTER_WIDTH{1'b0}};
+            locked     <= 1'b0;
+            overflow   <= 1'b0;
+            reserve_n  <= 32'd1;
+            counter_hi <= 32'h0;
+
+        end else begin
+            // Atomic fetch-and-increment / reserve
+            if (fetch_re) begin
+                counter_hi <= high_word(fetch_val);
+                if (fetch_ok)
+                    counter <= counter + fetch_n;
+                else if (!locked && fetch_n != 0)
+                    overflow <= 1'b1;
+            end
+
+            if (re && addr == ADDR_COUNTER)
+                counter_hi <= high_word(counter);
+
+            if (we && addr == ADDR_COUNTER_HI)
+                counter_hi <= wdata;
+
+            if (we && addr == ADDR_RESERVE_N)
+                reserve_n <= wdata;
+
+            if (!locked && we) begin
+                case (addr)
+                    ADDR_CTRL: begin
+                        // Increment counter
+                        if (wdata[CTRL_INCREMENT]) begin
+                            if (counter == COUNTER_MAX) begin
+                                overflow <= 1'b1;  // Saturate at max
+                            end else begin
+                                counter <= counter + 1;
+                            end
+                        end
+
+                        // Load counter: CTRL_LOAD bit triggers increment (for compatibility)
+                        // Actual counter value should be written to ADDR_COUNTER register
+                        if (wdata[CTRL_LOAD]) begin
+                            // This is a no-op - use ADDR_COUNTER for direct writes
+                            // Kept for API compatibility
                         end
                     end
-                    
-                    // Load counter: CTRL_LOAD bit triggers increment (for compatibility)
-                    // Actual counter value should be written to ADDR_COUNTER register
-                    if (wdata[CTRL_LOAD]) begin
-                        // This is a no-op - use ADDR_COUNTER for direct writes
-                        // Kept for API compatibility
-                    end
-                end
-                
-                ADDR_COUNTER: begin
-                    // Direct write: only accept if value > current counter
-                    if (wdata > counter && !overflow) begin
-                        counter <= wdata;
+
+                    ADDR_COUNTER: begin
+                        // Direct write: only accept if value > current counter
+                        if (load_val > counter && !overflow) begin
+                            counter <= load_val;
+                        end
                     end
-                end
-                
-                ADDR_LOCK: begin
-                    // Lock counter permanently
-                    if (wdata == LOCK_MAGIC) begin
-                        locked <= 1'b1;
+
+                    ADDR_LOCK: begin
+                        // Lock counter permanently
+                        if (wdata == LOCK_MAGIC) begin
+                            locked <= 1'b1;
+                        end
                     end
-                end
-            endcase
+
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+    //=================================================================
+    // Version Floor (check and advance in one write)
+    //=================================================================
+    wire ver_check = we && (addr == ADDR_VER_CHECK);
+    wire ver_pass  = !ver_locked && (wdata >= ver_floor);
+
+    always @(posedge clk or negedge por_n) begin
+        if (!por_n)
+            ver_floor <= 32'h0;
+        else if (ver_check && ver_pass)
+            ver_floor <= wdata;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            ver_locked <= 1'b0;
+            ver_ok     <= 1'b0;
+        end else begin
+            if (ver_check)
+                ver_ok <= ver_pass;
+            if (we && addr == ADDR_VER_LOCK && wdata == LOCK_MAGIC)
+                ver_locked <= 1'b1;
         end
     end
 
@@ -110,11 +234,16 @@ module monotonic_counter (
     //=================================================================
     always @(*) begin
         case (addr)
-            ADDR_COUNTER: rdata = counter;
-            ADDR_STATUS:  rdata = {30'h0, overflow, locked};
-            default:      rdata = 32'h0;
+            ADDR_COUNTER:      rdata = counter[31:0];
+            ADDR_STATUS:       rdata = {29'h0, ver_locked, overflow, locked};
+            ADDR_INC_AND_READ: rdata = fetch_val[31:0];
+            ADDR_RESERVE:      rdata = fetch_val[31:0];
+            ADDR_RESERVE_N:    rdata = reserve_n;
+            ADDR_COUNTER_HI:   rdata = counter_hi;
+            ADDR_VER_FLOOR:    rdata = ver_floor;
+            ADDR_VER_CHECK:    rdata = {31'h0, ver_ok};
+            default:           rdata = 32'h0;
         endcase
     end
 
 endmodule
-
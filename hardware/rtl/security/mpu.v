@@ -1,165 +1,212 @@
 /*
  * Memory Protection Unit (MPU) for Smart Lock SoC
- * 
+ *
  * Provides hardware-enforced memory protection to prevent:
  * - Unauthorized access to encryption keys
  * - Firmware modification attempts
  * - Bootloader tampering
- * 
- * Memory Regions:
- *   Boot ROM:   0x00000000 - 0x00000FFF (Read/Execute only)
- *   Firmware:   0x00010000 - 0x0001FFFF (Read/Execute only)
- *   Data RAM:   0x10000000 - 0x1000FFFF (Read/Write/Execute)
- *   UART:       0x20000000 - 0x200000FF (Read/Write)
- *   Key Store:  0x40000000 - 0x400000FF (Machine mode only)
+ *
+ * PMP-style programmable regions. Region n matches when
+ *   (addr & MASK[n]) == BASE[n]
+ * so every region is a naturally aligned power-of-two block. All
+ * regions are compared in parallel; the lowest-numbered matching region
+ * decides (one-hot select, no priority chain), and an access that
+ * matches no region is denied.
+ *
+ * Reset configuration (the SoC memory map):
+ *   0: Boot ROM:    0x00000000 - 0x00000FFF (Read/Execute only)
+ *   1: Firmware:    0x00010000 - 0x0001FFFF (Read/Execute only)
+ *   2: Data RAM:    0x10000000 - 0x1000FFFF (Read/Write/Execute)
+ *   3: UART:        0x20000000 - 0x200000FF (Read/Write)
+ *   4: Crypto:      0x30000000 - 0x300000FF (Read/Write)
+ *   5: Key Store:   0x40000000 - 0x400000FF (Machine mode only)
+ *   6: Anti-Replay: 0x50000000 - 0x500000FF (Read/Write)
+ *   7: SysCtrl:     0x60000000 - 0x600000FF (Read/Write)
+ *   8: DMA:         0x70000000 - 0x700000FF (Read/Write)
+ *   9: Trace:       0x80000000 - 0x800000FF (Read/Write)
+ *  10: MPU config:  0x90000000 - 0x900001FF (Read/Write)
+ *  11-15: disabled
+ *
+ * Configuration (0x90000000, base + offset):
+ *   0x000: NUM_REGIONS - Number of regions (R)
+ *   0x004: LOCK        - Bit n locks region n until reset (R, write 1 to set)
+ *   0x100 + n*0x10: BASE[n]  (R/W)
+ *   0x104 + n*0x10: MASK[n]  (R/W)
+ *   0x108 + n*0x10: ATTR[n]  (R/W)
+ *       [0] R  [1] W  [2] X  [3] PRIV (machine mode only)
+ *       [4] ENABLE  [7] LOCK (read-only, mirrors LOCK register)
+ *
+ * Writes to a locked region are ignored. The boot ROM locks the reset
+ * regions before entering the firmware; higher-numbered regions can
+ * never override a locked lower-numbered one.
+ *
+ * Check ports: the region table is shared by NUM_PORTS independent
+ * checkers. Each port reports the read, write and execute permission
+ * for its address at once, so a caller can check an address before it
+ * knows the access type (look-ahead, see soc_top.v).
  */
 
 `timescale 1ns / 1ps
 
-module mpu (
-    // Memory access signals from CPU
-    input  wire [31:0] addr,            // Memory address being accessed
-    input  wire        is_write,        // Write operation?
-    input  wire        is_exec,         // Instruction fetch?
-    input  wire        privileged_mode, // CPU in machine mode? (0=user, 1=machine)
-    
-    // Protection status
-    output reg         violation,       // Access violation detected
-    output reg         access_allowed   // Access permitted
+module mpu #(
+    parameter NUM_REGIONS = 16,         // Max 16 (register map)
+    parameter NUM_PORTS   = 1           // Independent check ports
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Configuration interface (memory-mapped)
+    input  wire [6:0]  cfg_addr,        // Register address (byte offset / 4)
+    input  wire        cfg_we,          // Write enable
+    input  wire [31:0] cfg_wdata,       // Write data
+    output reg  [31:0] cfg_rdata,       // Read data
+
+    // Check ports (port n uses addr[n*32 +: 32])
+    input  wire [NUM_PORTS*32-1:0] addr,            // Address to check
+    input  wire [NUM_PORTS-1:0]    privileged_mode, // Machine mode? (0=user, 1=machine)
+
+    // Permissions for each port (0 = access would be a violation)
+    output wire [NUM_PORTS-1:0]    allow_read,
+    output wire [NUM_PORTS-1:0]    allow_write,
+    output wire [NUM_PORTS-1:0]    allow_exec
 );
 
     //=================================================================
-    // Memory Region Definitions
+    // Register Map
     //=================================================================
-    
-    // Boot ROM - Immutable bootloader
-    localparam BOOT_ROM_START   = 32'h00000000;
-    localparam BOOT_ROM_END     = 32'h00000FFF;
-    
-    // Firmware - Application code
-    localparam FIRMWARE_START   = 32'h00010000;
-    localparam FIRMWARE_END     = 32'h0001FFFF;
-    
-    // Data Memory - Stack, heap, variables
-    localparam DATA_MEM_START   = 32'h10000000;
-    localparam DATA_MEM_END     = 32'h1000FFFF;
-    
-    // UART Peripheral
-    localparam UART_START       = 32'h20000000;
-    localparam UART_END         = 32'h200000FF;
-    
-    // Crypto Accelerator
-    localparam CRYPTO_START      = 32'h30000000;
-    localparam CRYPTO_END        = 32'h300000FF;
-    
-    // Key Store - PROTECTED REGION
-    localparam KEY_STORE_START  = 32'h40000000;
-    localparam KEY_STORE_END    = 32'h400000FF;
-    
-    // Anti-Replay Protection
-    localparam ANTI_REPLAY_START = 32'h50000000;
-    localparam ANTI_REPLAY_END   = 32'h500000FF;
-    
+    localparam ADDR_NUM_REGIONS = 7'h00;
+    localparam ADDR_LOCK        = 7'h01;
+
     //=================================================================
-    // Protection Logic (Combinational - No clock cycles!)
+    // Attribute Bits
     //=================================================================
-    
-    always @(*) begin
-        // Default: deny access
-        violation = 1'b0;
-        access_allowed = 1'b0;
-        
-        //-------------------------------------------------------------
-        // Boot ROM Protection
-        //-------------------------------------------------------------
-        if (addr >= BOOT_ROM_START && addr <= BOOT_ROM_END) begin
-            if (is_write) begin
-                // VIOLATION: Cannot write to boot ROM
-                violation = 1'b1;
-                access_allowed = 1'b0;
-            end else begin
-                // OK: Can read/execute boot ROM
-                violation = 1'b0;
-                access_allowed = 1'b1;
-            end
+    localparam ATTR_R      = 0;
+    localparam ATTR_W      = 1;
+    localparam ATTR_X      = 2;
+    localparam ATTR_PRIV   = 3;
+    localparam ATTR_ENABLE = 4;
+
+    localparam [4:0] ATTR_RX   = 5'b10101;
+    localparam [4:0] ATTR_RW   = 5'b10011;
+    localparam [4:0] ATTR_RWX  = 5'b10111;
+    localparam [4:0] ATTR_PRW  = 5'b11011;
+    localparam [4:0] ATTR_NONE = 5'b00000;
+
+    //=================================================================
+    // Reset Configuration
+    //=================================================================
+    function [68:0] reset_region;       // {base, mask, attr}
+        input integer n;
+        begin
+            case (n)
+                0:  reset_region = {32'h00000000, 32'hFFFFF000, ATTR_RX};   // Boot ROM
+                1:  reset_region = {32'h00010000, 32'hFFFF0000, ATTR_RX};   // Firmware
+                2:  reset_region = {32'h10000000, 32'hFFFF0000, ATTR_RWX};  // Data RAM
+                3:  reset_region = {32'h20000000, 32'hFFFFFF00, ATTR_RW};   // UART
+                4:  reset_region = {32'h30000000, 32'hFFFFFF00, ATTR_RW};   // Crypto
+                5:  reset_region = {32'h40000000, 32'hFFFFFF00, ATTR_PRW};  // Key Store
+                6:  reset_region = {32'h50000000, 32'hFFFFFF00, ATTR_RW};   // Anti-Replay
+                7:  reset_region = {32'h60000000, 32'hFFFFFF00, ATTR_RW};   // SysCtrl
+                8:  reset_region = {32'h70000000, 32'hFFFFFF00, ATTR_RW};   // DMA
+                9:  reset_region = {32'h80000000, 32'hFFFFFF00, ATTR_RW};   // Trace
+                10: reset_region = {32'h90000000, 32'hFFFFFE00, ATTR_RW};   // MPU config
+                default: reset_region = {32'h00000000, 32'hFFFFFFFF, ATTR_NONE};
+            endcase
         end
-        
-        //-------------------------------------------------------------
-        // Firmware Protection
-        //-------------------------------------------------------------
-        else if (addr >= FIRMWARE_START && addr <= FIRMWARE_END) begin
-            if (is_write) begin
-                // VIOLATION: Cannot write to firmware (no self-modification)
-                violation = 1'b1;
-                access_allowed = 1'b0;
-            end else begin
-                // OK: Can read/execute firmware
-                violation = 1'b0;
-                access_allowed = 1'b1;
+    endfunction
+
+    //=================================================================
+    // Region Registers
+    //=================================================================
+    reg [31:0]            region_base [0:NUM_REGIONS-1];
+    reg [31:0]            region_mask [0:NUM_REGIONS-1];
+    reg [4:0]             region_attr [0:NUM_REGIONS-1];
+    reg [NUM_REGIONS-1:0] lock;
+
+    // Region registers live at cfg_addr 0x40-0x7F (byte offset 0x100-0x1FF)
+    wire [3:0] cfg_region    = cfg_addr[5:2];
+    wire [1:0] cfg_field     = cfg_addr[1:0];
+    wire       cfg_is_region = cfg_addr[6] && (cfg_region < NUM_REGIONS);
+
+    integer i;
+    reg [68:0] rst_cfg;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            lock <= {NUM_REGIONS{1'b0}};
+            for (i = 0; i < NUM_REGIONS; i = i + 1) begin
+                rst_cfg = reset_region(i);
+                region_base[i] <= rst_cfg[68:37];
+                region_mask[i] <= rst_cfg[36:5];
+                region_attr[i] <= rst_cfg[4:0];
             end
-        end
-        
-        //-------------------------------------------------------------
-        // Data Memory Protection
-        //-------------------------------------------------------------
-        else if (addr >= DATA_MEM_START && addr <= DATA_MEM_END) begin
-            // OK: Full access to data memory
-            violation = 1'b0;
-            access_allowed = 1'b1;
-        end
-        
-        //-------------------------------------------------------------
-        // UART Protection
-        //-------------------------------------------------------------
-        else if (addr >= UART_START && addr <= UART_END) begin
-            // OK: Can access UART
-            violation = 1'b0;
-            access_allowed = 1'b1;
-        end
-        
-        //-------------------------------------------------------------
-        // Crypto Accelerator Protection
-        //-------------------------------------------------------------
-        else if (addr >= CRYPTO_START && addr <= CRYPTO_END) begin
-            // OK: Can access crypto accelerator (needed for secure boot)
-            violation = 1'b0;
-            access_allowed = 1'b1;
-        end
-        
-        //-------------------------------------------------------------
-        // KEY STORE Protection - CRITICAL SECURITY FEATURE
-        //-------------------------------------------------------------
-        else if (addr >= KEY_STORE_START && addr <= KEY_STORE_END) begin
-            if (privileged_mode) begin
-                // OK: Machine mode can access keys
-                violation = 1'b0;
-                access_allowed = 1'b1;
-            end else begin
-                // VIOLATION: User mode CANNOT access keys!
-                // This prevents malware from stealing encryption keys
-                violation = 1'b1;
-                access_allowed = 1'b0;
+        end else if (cfg_we) begin
+            if (cfg_addr == ADDR_LOCK) begin
+                lock <= lock | cfg_wdata[NUM_REGIONS-1:0];
+            end else if (cfg_is_region && !lock[cfg_region]) begin
+                case (cfg_field)
+                    2'd0: region_base[cfg_region] <= cfg_wdata;
+                    2'd1: region_mask[cfg_region] <= cfg_wdata;
+                    2'd2: region_attr[cfg_region] <= cfg_wdata[4:0];
+                    default: ;
+                endcase
             end
         end
-        
-        //-------------------------------------------------------------
-        // Anti-Replay Protection
-        //-------------------------------------------------------------
-        else if (addr >= ANTI_REPLAY_START && addr <= ANTI_REPLAY_END) begin
-            // OK: Can access anti-replay modules
-            violation = 1'b0;
-            access_allowed = 1'b1;
+    end
+
+    //=================================================================
+    // Protection Logic (Combinational - No clock cycles!)
+    //=================================================================
+    // Every port compares its address against all regions in parallel.
+    // The lowest-numbered hit wins; with no hit, select is zero and
+    // every access type is denied.
+    genvar p, g;
+    generate
+        for (p = 0; p < NUM_PORTS; p = p + 1) begin : gen_port
+            wire [31:0]            port_addr = addr[p*32 +: 32];
+            wire [NUM_REGIONS-1:0] hit;
+            wire [NUM_REGIONS-1:0] can_r;
+            wire [NUM_REGIONS-1:0] can_w;
+            wire [NUM_REGIONS-1:0] can_x;
+
+            for (g = 0; g < NUM_REGIONS; g = g + 1) begin : gen_region
+                wire [4:0] attr   = region_attr[g];
+                wire       priv_ok = !attr[ATTR_PRIV] || privileged_mode[p];
+
+                assign hit[g]   = attr[ATTR_ENABLE] &&
+                                  ((port_addr & region_mask[g]) == region_base[g]);
+                assign can_r[g] = attr[ATTR_R] && priv_ok;
+                assign can_w[g] = attr[ATTR_W] && priv_ok;
+                assign can_x[g] = attr[ATTR_X] && priv_ok;
+            end
+
+            // Isolate the lowest set bit (one-hot region select)
+            wire [NUM_REGIONS-1:0] select = hit & (~hit + 1'b1);
+
+            assign allow_read[p]  = |(select & can_r);
+            assign allow_write[p] = |(select & can_w);
+            assign allow_exec[p]  = |(select & can_x);
         end
-        
-        //-------------------------------------------------------------
-        // Unmapped Region
-        //-------------------------------------------------------------
-        else begin
-            // VIOLATION: Accessing unmapped memory
-            violation = 1'b1;
-            access_allowed = 1'b0;
+    endgenerate
+
+    //=================================================================
+    // Configuration Read Interface
+    //=================================================================
+    always @(*) begin
+        cfg_rdata = 32'h0;
+        if (cfg_is_region) begin
+            case (cfg_field)
+                2'd0: cfg_rdata = region_base[cfg_region];
+                2'd1: cfg_rdata = region_mask[cfg_region];
+                2'd2: cfg_rdata = {24'h0, lock[cfg_region], 2'b00, region_attr[cfg_region]};
+                default: cfg_rdata = 32'h0;
+            endcase
+        end else begin
+            case (cfg_addr)
+                ADDR_NUM_REGIONS: cfg_rdata = NUM_REGIONS;
+                ADDR_LOCK:        cfg_rdata[NUM_REGIONS-1:0] = lock;
+                default:          cfg_rdata = 32'h0;
+            endcase
         end
     end
 
 endmodule
-
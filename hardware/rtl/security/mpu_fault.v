@@ -0,0 +1,127 @@
+/*
+ * MPU Fault Capture
+ *
+ * Records MPU violations so firmware can log them and continue. The
+ * SoC always blocks a violating access (writes are dropped, reads
+ * return 0); FAULT_CTRL selects whether it is also reported as a
+ * trap (legacy, halts the CPU) and/or as an interrupt.
+ *
+ * Memory Map (base + offset, base = 0x90000040):
+ *   0x00: FAULT_ADDR  - Address of the last violating access (R)
+ *   0x04: FAULT_INFO  - Access type of the last violation (R, W1C VALID)
+ *   0x08: FAULT_PC    - Last instruction fetch of the faulting hart (R)
+ *   0x0C: FAULT_COUNT - Violations since reset (R, write clears)
+ *   0x10: FAULT_CTRL  - Reporting mode (R/W)
+ *
+ * FAULT_INFO bits:
+ *   0: VALID    - A fault was recorded (write 1 to clear)
+ *   1: OVERRUN  - Another fault arrived while VALID was set
+ *   2: READ  3: WRITE  4: EXEC
+ *   5: PRIV     - Access was made in machine mode
+ *   10:8: MASTER - Bus master (0/1 = hart, 2 = crypto, 3 = DMA, 4 = UART,
+ *                   5 = page verifier)
+ *
+ * FAULT_CTRL bits (reset: TRAP_EN):
+ *   0: TRAP_EN  - CPU violations raise the SoC trap
+ *   1: IRQ_EN   - Raise irq while VALID is set
+ */
+
+`timescale 1ns / 1ps
+
+module mpu_fault (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU Interface (memory-mapped)
+    input  wire [2:0]  addr,        // Register address (byte offset / 4)
+    input  wire        we,          // Write enable
+    input  wire [31:0] wdata,       // Write data
+    output reg  [31:0] rdata,       // Read data
+
+    // Violation from the bus (one cycle per blocked access)
+    input  wire        fault,
+    input  wire [31:0] fault_addr,
+    input  wire        fault_write,
+    input  wire        fault_exec,
+    input  wire        fault_priv,
+    input  wire [2:0]  fault_master,
+    input  wire [31:0] fault_pc,
+
+    // Reporting
+    output wire        trap_en,
+    output wire        irq
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_FAULT_ADDR  = 3'h0;
+    localparam ADDR_FAULT_INFO  = 3'h1;
+    localparam ADDR_FAULT_PC    = 3'h2;
+    localparam ADDR_FAULT_COUNT = 3'h3;
+    localparam ADDR_FAULT_CTRL  = 3'h4;
+
+    localparam INFO_VALID   = 0;
+    localparam INFO_OVERRUN = 1;
+
+    localparam CTRL_TRAP_EN = 0;
+    localparam CTRL_IRQ_EN  = 1;
+
+    //=================================================================
+    // Registers
+    //=================================================================
+    reg [31:0] addr_reg;
+    reg [10:0] info_reg;
+    reg [31:0] pc_reg;
+    reg [31:0] count;
+    reg [1:0]  ctrl_reg;
+
+    assign trap_en = ctrl_reg[CTRL_TRAP_EN];
+    assign irq     = info_reg[INFO_VALID] && ctrl_reg[CTRL_IRQ_EN];
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            addr_reg <= 32'h0;
+            info_reg <= 11'h0;
+            pc_reg   <= 32'h0;
+            count    <= 32'h0;
+            ctrl_reg <= (1 << CTRL_TRAP_EN);
+        end else begin
+            if (we) begin
+                case (addr)
+                    ADDR_FAULT_INFO:  if (wdata[INFO_VALID]) info_reg[1:0] <= 2'b00;
+                    ADDR_FAULT_COUNT: count <= 32'h0;
+                    ADDR_FAULT_CTRL:  ctrl_reg <= wdata[1:0];
+                    default: ;
+                endcase
+            end
+
+            // A new fault wins over a simultaneous clear
+            if (fault) begin
+                addr_reg <= fault_addr;
+                pc_reg   <= fault_pc;
+                info_reg <= {fault_master, 2'b00, fault_priv, fault_exec,
+                             fault_write && !fault_exec,
+                             !fault_write && !fault_exec,
+                             info_reg[INFO_VALID] || info_reg[INFO_OVERRUN], 1'b1};
+                if (count != 32'hFFFFFFFF)
+                    count <= count + 1;
+            end
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        case (addr)
+            ADDR_FAULT_ADDR:  rdata = addr_reg;
+            ADDR_FAULT_INFO:  rdata = {21'h0, info_reg};
+            ADDR_FAULT_PC:    rdata = pc_reg;
+            ADDR_FAULT_COUNT: rdata = count;
+            ADDR_FAULT_CTRL:  rdata = {30'h0, ctrl_reg};
+            default:          rdata = 32'h0;
+        endcase
+    end
+
+endmodule
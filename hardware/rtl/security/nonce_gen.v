@@ -1,31 +1,58 @@
 /*
  * Nonce Generator Module
- * 
+ *
  * Generates pseudo-random nonces for anti-replay protection.
- * Uses a 32-bit Galois LFSR with maximum period.
- * 
+ * Counter-mode DRBG on a SHA-256 core: block n of output is
+ *   SHA-256(key || n)
+ * with a 256-bit key and a 64-bit block counter, so output words are
+ * uncorrelated and never repeat for one key (2^64 blocks of 8 words).
+ *
  * Features:
- * - 32-bit pseudo-random number generation
- * - Maximum period LFSR (2^32 - 1 unique values)
- * - Hardware-seeded from timestamp
- * - Automatic advancement every clock cycle
- * 
+ * - 256 bits per SHA-256 block (8 nonce words, ~70 cycles)
+ * - Prefilled FIFO_DEPTH word FIFO, refilled in the background, so a
+ *   NONCE read never waits for the hash
+ * - Read-to-advance mode: every NONCE read returns a fresh word; a 64-
+ *   or 128-bit nonce is 2 or 4 consecutive reads
+ * - Reads from any bus master pop (DMA with a fixed source fills a
+ *   buffer of nonces)
+ *
+ * The key starts from a fixed value at reset; SEED mixes one word into
+ * it and discards the words generated under the old key. Firmware
+ * should seed from an entropy source (the nonces also repeat after a
+ * reset otherwise, like the anti-replay state).
+ *
  * Memory Map (base + offset):
- *   0x00: NONCE  - Read current nonce (R, reading advances LFSR)
- *   0x04: SEED   - Write seed value (W)
- *   0x08: CTRL   - Control register (W)
- *   0x0C: STATUS - Status register (R)
+ *   0x00: NONCE  - Oldest FIFO word (R, reading pops in READ_ADVANCE mode)
+ *   0x04: SEED   - Mix a word into the key (W)
+ *   0x08: CTRL   - Control register (R/W)
+ *   0x0C: STATUS - Status register (R, write 1 to bit 16 clears UNDERFLOW)
+ *
+ * CTRL bits (reset: ENABLE | READ_ADVANCE):
+ *   0: ENABLE       - Refill the FIFO
+ *   1: ADVANCE      - Drop the oldest word (action, reads 0). A write
+ *                     with ADVANCE set leaves ENABLE and READ_ADVANCE
+ *                     as they are; other writes set them
+ *   2: READ_ADVANCE - Each NONCE read pops the word it returns (mode)
+ *
+ * STATUS bits:
+ *   0:     READY     - FIFO not empty
+ *   13:8:  LEVEL     - Words in the FIFO
+ *   16:    UNDERFLOW - NONCE was read while empty (returned 0)
  */
 
 `timescale 1ns / 1ps
 
-module nonce_gen (
+module nonce_gen #(
+    parameter FIFO_DEPTH = 32,      // Words (multiple of 8, max 32)
+    parameter FIFO_BITS  = 5        // log2(FIFO_DEPTH)
+)(
     input  wire        clk,
     input  wire        rst_n,
-    
+
     // CPU Interface (memory-mapped)
-    input  wire [3:0]  addr,        // Register address (byte offset / 4)
+    input  wire [3:0]  addr,        // Register address (byte offset)
     input  wire        we,          // Write enable
+    input  wire        re,          // Read strobe (pops NONCE)
     input  wire [31:0] wdata,       // Write data
     output reg  [31:0] rdata        // Read data
 );
@@ -41,79 +68,185 @@ module nonce_gen (
     //=================================================================
     // Control Bits
     //=================================================================
-    localparam CTRL_ENABLE  = 0;
-    localparam CTRL_ADVANCE = 1;
-    
-    localparam STATUS_READY = 0;
+    localparam CTRL_ENABLE       = 0;
+    localparam CTRL_ADVANCE      = 1;
+    localparam CTRL_READ_ADVANCE = 2;
+
+    localparam STATUS_READY     = 0;
+    localparam STATUS_UNDERFLOW = 16;
 
     //=================================================================
-    // LFSR Polynomial: x^32 + x^22 + x^2 + x^1 + 1
-    // Taps at bits [32, 22, 2, 1] for maximum period
+    // DRBG Reset Key (any value; SEED replaces it)
     //=================================================================
-    localparam [31:0] LFSR_TAPS = 32'h80200003;
+    localparam [255:0] KEY_INIT = 256'hACE1BABE_5EED0001_9E3779B9_7F4A7C15_F39CC060_5CEDC834_1082276B_F3A27251;
 
     //=================================================================
     // Internal Registers
     //=================================================================
-    reg [31:0] lfsr;
-    reg        enabled;
-    reg        ready;
-    reg [7:0]  init_counter;  // Warm-up cycles
+    reg         enabled;
+    reg         read_advance;
+    reg         underflow;
+
+    reg [255:0] drbg_key;
+    reg [63:0]  drbg_ctr;
+    reg [255:0] blk;                // Last SHA output, moved to the FIFO
+    reg [3:0]   blk_words;          // Words of blk not yet in the FIFO
+
+    reg [31:0]          fifo [0:FIFO_DEPTH-1];
+    reg [FIFO_BITS-1:0] head;
+    reg [FIFO_BITS-1:0] tail;
+    reg [FIFO_BITS:0]   count;
+
+    //=================================================================
+    // SHA-256 Instance
+    //=================================================================
+    localparam G_IDLE = 2'd0;
+    localparam G_INIT = 2'd1;       // Reset the chaining value
+    localparam G_HASH = 2'd2;       // Hash {key, counter}
+
+    reg  [1:0]   gen_state;
+    reg          sha_init;
+    reg          sha_next;
+    reg  [511:0] sha_block;         // Latched: SEED may change the key
+    reg          stale;             // Key changed while hashing
+    wire [255:0] sha_hash;
+    wire         sha_ready;
+
+    // One padded block: key (256) || counter (64) || 0x80 || 0 || length 320
+    wire [511:0] drbg_block = {drbg_key, drbg_ctr, 8'h80, 120'h0, 64'd320};
+
+    sha256 sha_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .init(sha_init),
+        .next_block(sha_next),
+        .block_in(sha_block),
+        .hash_out(sha_hash),
+        .ready(sha_ready)
+    );
+
+    wire sha_idle = sha_ready && !sha_next && !sha_init;
 
     //=================================================================
-    // LFSR Logic (Galois configuration)
+    // FIFO Control
     //=================================================================
-    wire       feedback;
-    wire [31:0] lfsr_next;
-    
-    assign feedback = lfsr[0];
-    assign lfsr_next = feedback ? ({1'b0, lfsr[31:1]} ^ LFSR_TAPS) : {1'b0, lfsr[31:1]};
+    wire empty = (count == 0);
+    wire pop   = !empty &&
+                 ((re && addr == ADDR_NONCE && read_advance) ||
+                  (we && addr == ADDR_CTRL && wdata[CTRL_ADVANCE]));
+    wire push  = (blk_words != 0) && (count != FIFO_DEPTH);
+
+    // Room for a whole block once the one being moved is in
+    wire room  = (count + blk_words) <= (FIFO_DEPTH - 8);
+
+    // SEED discards everything generated under the old key
+    wire reseed = we && (addr == ADDR_SEED);
+
+    always @(posedge clk) begin
+        if (push)
+            fifo[tail] <= blk[255:224];
+    end
 
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            lfsr         <= 32'hACE1BABE;  // Non-zero seed
-            enabled      <= 1'b1;          // Auto-enable
-            ready        <= 1'b0;
-            init_counter <= 8'd32;         // Warm-up period
-            
+            enabled      <= 1'b1;
+            read_advance <= 1'b1;
+            underflow    <= 1'b0;
+            drbg_key     <= KEY_INIT;
+            drbg_ctr     <= 64'h0;
+            blk          <= 256'h0;
+            blk_words    <= 4'd0;
+            head         <= {FIFO_BITS{1'b0}};
+            tail         <= {FIFO_BITS{1'b0}};
+            count        <= {(FIFO_BITS+1){1'b0}};
+            gen_state    <= G_IDLE;
+            sha_init     <= 1'b0;
+            sha_next     <= 1'b0;
+            sha_block    <= 512'h0;
+            stale        <= 1'b0;
+
         end else begin
-            // Warm-up: advance LFSR for initial mixing
-            if (init_counter > 0) begin
-                lfsr <= lfsr_next;
-                init_counter <= init_counter - 1;
-                if (init_counter == 1) begin
-                    ready <= 1'b1;
+            sha_init <= 1'b0;
+            sha_next <= 1'b0;
+
+            //---------------------------------------------------------
+            // Generator: one block whenever the FIFO has room for it
+            //---------------------------------------------------------
+            case (gen_state)
+                G_IDLE: begin
+                    if (enabled && room && sha_idle) begin
+                        sha_init  <= 1'b1;
+                        gen_state <= G_INIT;
+                    end
                 end
+
+                G_INIT: begin
+                    if (sha_idle) begin
+                        sha_block <= drbg_block;
+                        sha_next  <= 1'b1;
+                        drbg_ctr  <= drbg_ctr + 1;
+                        stale     <= 1'b0;
+                        gen_state <= G_HASH;
+                    end
+                end
+
+                G_HASH: begin
+                    if (sha_idle) begin
+                        blk       <= sha_hash;
+                        blk_words <= stale ? 4'd0 : 4'd8;
+                        gen_state <= G_IDLE;
+                    end
+                end
+
+                default: gen_state <= G_IDLE;
+            endcase
+
+            // Move the block into the FIFO, one word per cycle
+            if (push) begin
+                blk       <= {blk[223:0], 32'h0};
+                blk_words <= blk_words - 1;
+                tail      <= tail + 1'b1;
             end
-            
-            // Normal operation: advance if enabled
-            else if (enabled) begin
-                lfsr <= lfsr_next;
-            end
-            
+            if (pop)
+                head <= head + 1'b1;
+            count <= count + push - pop;
+
+            if (re && addr == ADDR_NONCE && empty)
+                underflow <= 1'b1;
+
+            //---------------------------------------------------------
             // Handle writes
+            //---------------------------------------------------------
             if (we) begin
                 case (addr)
-                    ADDR_SEED: begin
-                        // Re-seed LFSR (must be non-zero)
-                        if (wdata != 32'h0) begin
-                            lfsr <= wdata;
-                            ready <= 1'b0;
-                            init_counter <= 8'd32;  // Re-warm-up
-                        end
-                    end
-                    
                     ADDR_CTRL: begin
-                        // Enable/disable auto-advance
-                        enabled <= wdata[CTRL_ENABLE];
-                        
-                        // Manual advance
-                        if (wdata[CTRL_ADVANCE] && ready) begin
-                            lfsr <= lfsr_next;
+                        // ADVANCE is a one-shot action: keep the mode
+                        if (!wdata[CTRL_ADVANCE]) begin
+                            enabled      <= wdata[CTRL_ENABLE];
+                            read_advance <= wdata[CTRL_READ_ADVANCE];
                         end
                     end
+
+                    ADDR_STATUS: begin
+                        if (wdata[STATUS_UNDERFLOW])
+                            underflow <= 1'b0;
+                    end
+
+                    default: ;
                 endcase
             end
+
+            // Re-seed: mix the word in (rotate so 8 writes touch every
+            // key word), drop old output; a hash in flight is discarded
+            // when it completes
+            if (reseed) begin
+                drbg_key  <= {drbg_key[223:0], drbg_key[255:224] ^ wdata};
+                stale     <= 1'b1;
+                blk_words <= 4'd0;
+                head      <= {FIFO_BITS{1'b0}};
+                tail      <= {FIFO_BITS{1'b0}};
+                count     <= {(FIFO_BITS+1){1'b0}};
+            end
         end
     end
 
@@ -121,16 +254,17 @@ module nonce_gen (
     // Read Interface
     //=================================================================
     always @(*) begin
+        rdata = 32'h0;
         case (addr)
-            ADDR_NONCE:  rdata = lfsr;
-            ADDR_STATUS: rdata = {31'h0, ready};
+            ADDR_NONCE:  rdata = empty ? 32'h0 : fifo[head];
+            ADDR_CTRL:   rdata = {29'h0, read_advance, 1'b0, enabled};
+            ADDR_STATUS: begin
+                rdata[STATUS_READY]        = !empty;
+                rdata[8 +: FIFO_BITS+1]    = count;
+                rdata[STATUS_UNDERFLOW]    = underflow;
+            end
             default:     rdata = 32'h0;
         endcase
     end
 
 endmodule
-
-
-
-
-
@@ -0,0 +1,305 @@
+/*
+ * Firmware Page Verifier
+ *
+ * Checks firmware pages on first use instead of at boot. The boot ROM
+ * verifies the signed page-digest table (see boot_secure.S), programs
+ * its address and the image length here and sets ENABLE; from then on
+ * every bus access to an image page that is not yet verified is held
+ * off the bus until this block has hashed the page and compared it
+ * with its table entry. Boot therefore only waits for the pages it
+ * touches, and pages that never run are never hashed.
+ *
+ * A held access is stalled like a slow slave: its master's valid is
+ * removed before the arbiter, so the held master keeps its request
+ * and other masters continue. The page is read as bus master 5 by a
+ * private SHA-256 engine (hmac_sha256 in hash_only mode), then the 8
+ * digest words are fetched from the table and compared. A match sets
+ * the page's VERIFIED bit and releases the access; a mismatch sets
+ * FAIL, keeps the access held and raises the SoC trap.
+ *
+ * Image layout (common/firmware_header.h): page n covers image bytes
+ * n*4K .. min((n+1)*4K, LENGTH)-1, its digest is the 32 bytes at
+ * TABLE + n*32 in byte order. Accesses at or above LENGTH (page table,
+ * header, unused flash) are not held.
+ *
+ * TABLE and LENGTH are locked once ENABLE is set; ENABLE and FAIL only
+ * clear on reset. VERIFIED is kept across warm resets (only power-on
+ * reset clears it) and is cleared by any write to instruction memory,
+ * so after a warm reboot of an unchanged image the pages that were
+ * already checked run without being hashed again.
+ *
+ * Memory Map (base + offset):
+ *   0x00: CTRL     - Bit 0 ENABLE (R, write 1 to set)
+ *   0x04: TABLE    - Page digest table address (R/W until enabled)
+ *   0x08: LENGTH   - Image length in bytes (R/W until enabled)
+ *   0x0C: VERIFIED - Bit n set once page n has been verified (R)
+ *   0x10: STATUS   - Status register (R)
+ *
+ * STATUS bits:
+ *   0:    BUSY      - A page is being verified
+ *   1:    FAIL      - A page did not match its digest
+ *   11:8: FAIL_PAGE - Page that failed
+ */
+
+`timescale 1ns / 1ps
+
+module page_verifier #(
+    parameter NUM_PORTS = 5,                // Checked bus masters
+    parameter IMEM_BASE = 32'h00010000      // Firmware image base (64KB, 16 pages)
+)(
+    input  wire                    clk,
+    input  wire                    rst_n,
+    input  wire                    por_n,       // Power-on reset (VERIFIED)
+    input  wire                    imem_write,  // Instruction memory written
+
+    // CPU Interface (memory-mapped)
+    input  wire [2:0]              addr,        // Register address (word index)
+    input  wire                    we,          // Write enable
+    input  wire [31:0]             wdata,       // Write data
+    output reg  [31:0]             rdata,       // Read data
+
+    // Access check: master n requests chk_addr[n*32 +: 32]
+    input  wire [NUM_PORTS-1:0]    chk_valid,
+    input  wire [NUM_PORTS*32-1:0] chk_addr,
+    output wire [NUM_PORTS-1:0]    hold,        // Keep master n off the bus
+
+    // Memory interface (page and table reads)
+    output wire                    mem_valid,
+    output wire [31:0]             mem_addr,
+    input  wire [31:0]             mem_rdata,
+    input  wire                    mem_ready,
+
+    output wire                    fail         // Page mismatch (sticky)
+);
+
+    //=================================================================
+    // Register Map
+    //=================================================================
+    localparam ADDR_CTRL     = 3'd0;
+    localparam ADDR_TABLE    = 3'd1;
+    localparam ADDR_LENGTH   = 3'd2;
+    localparam ADDR_VERIFIED = 3'd3;
+    localparam ADDR_STATUS   = 3'd4;
+
+    localparam CTRL_ENABLE   = 0;
+
+    localparam STATUS_BUSY   = 0;
+    localparam STATUS_FAIL   = 1;
+
+    localparam [31:0] IMEM_SIZE = 32'h00010000;
+    localparam [31:0] PAGE_SIZE = 32'h00001000;
+
+    //=================================================================
+    // Internal Registers
+    //=================================================================
+    reg         enabled;
+    reg  [31:0] table_addr;
+    reg  [31:0] img_len;
+    reg  [15:0] verified;
+    reg         failed;
+    reg  [3:0]  fail_page;
+
+    //=================================================================
+    // Access Check
+    //=================================================================
+    // Page of each request (image offset bits 15:12)
+    wire [NUM_PORTS*4-1:0] chk_page;
+
+    genvar gi;
+    generate
+        for (gi = 0; gi < NUM_PORTS; gi = gi + 1) begin : g_check
+            wire [31:0] off = chk_addr[gi*32 +: 32] - IMEM_BASE;
+            assign chk_page[gi*4 +: 4] = off[15:12];
+            assign hold[gi] = chk_valid[gi] && enabled &&
+                              (off < IMEM_SIZE) && (off < img_len) &&
+                              !verified[off[15:12]];
+        end
+    endgenerate
+
+    // Lowest-numbered held master picks the next page
+    reg [3:0] req_page;
+    integer   i;
+
+    always @(*) begin
+        req_page = 4'd0;
+        for (i = NUM_PORTS - 1; i >= 0; i = i - 1)
+            if (hold[i])
+                req_page = chk_page[i*4 +: 4];
+    end
+
+    // Bytes of the image in a page: min(4K, LENGTH - page offset)
+    wire [31:0] req_off   = {16'h0, req_page, 12'h000};
+    wire [31:0] req_bytes = (img_len - req_off > PAGE_SIZE) ? PAGE_SIZE : img_len - req_off;
+
+    //=================================================================
+    // SHA-256 Engine
+    //=================================================================
+    localparam V_IDLE  = 2'd0;
+    localparam V_HASH  = 2'd1;      // Hash the page
+    localparam V_TABLE = 2'd2;      // Fetch and compare the 8 digest words
+
+    reg  [1:0]   state;
+    reg  [3:0]   cur_page;
+    reg          hash_start;
+    reg  [31:0]  hash_addr;
+    reg  [31:0]  hash_len;
+    reg  [255:0] digest;            // Remaining words, next in [255:224]
+    reg  [2:0]   word;
+    reg          mismatch;
+
+    wire [31:0]  hash_mem_addr;
+    wire         hash_mem_valid;
+    wire [255:0] hash_out;
+    wire         hash_ready;
+    wire         hash_done;
+
+    hmac_sha256 hash_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .start(hash_start),
+        .hash_only(1'b1),
+        .cont(1'b0),
+        .more(1'b0),
+        .key(256'h0),
+        .msg_addr(hash_addr),
+        .msg_len(hash_len),
+        .mem_addr(hash_mem_addr),
+        .mem_valid(hash_mem_valid),
+        .mem_rdata(mem_rdata),
+        .mem_ready(mem_ready && state == V_HASH),
+        .mac_out(hash_out),
+        .ready(hash_ready),
+        .done(hash_done)
+    );
+
+    // Table words are memory bytes in order; hash_out is big-endian
+    wire [31:0] table_word = {mem_rdata[7:0], mem_rdata[15:8],
+                              mem_rdata[23:16], mem_rdata[31:24]};
+    wire        word_bad   = (table_word != digest[255:224]);
+
+    assign mem_valid = (state == V_HASH)  ? hash_mem_valid :
+                       (state == V_TABLE);
+    assign mem_addr  = (state == V_HASH)  ? hash_mem_addr :
+                       table_addr + {23'h0, cur_page, word, 2'b00};
+
+    assign fail = failed;
+
+    // Last table word of a page that matched
+    wire page_ok = (state == V_TABLE) && mem_ready && (word == 3'd7) &&
+                   !mismatch && !word_bad;
+
+    always @(posedge clk or negedge por_n) begin
+        if (!por_n)
+            verified <= 16'h0;
+        else if (imem_write)
+            verified <= 16'h0;
+        else if (page_ok)
+            verified[cur_page] <= 1'b1;
+    end
+
+    //=================================================================
+    // Verification and Register Writes
+    //=================================================================
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            enabled    <= 1'b0;
+            table_addr <= 32'h0;
+            img_len    <= 32'h0;
+            failed     <= 1'b0;
+            fail_page  <= 4'd0;
+            state      <= V_IDLE;
+            cur_page   <= 4'd0;
+            hash_start <= 1'b0;
+            hash_addr  <= 32'h0;
+            hash_len   <= 32'h0;
+            digest     <= 256'h0;
+            word       <= 3'd0;
+            mismatch   <= 1'b0;
+
+        end else begin
+            hash_start <= 1'b0;
+
+            case (state)
+                V_IDLE: begin
+                    if (|hold && !failed && hash_ready && !hash_start) begin
+                        cur_page   <= req_page;
+                        hash_addr  <= IMEM_BASE + req_off;
+                        hash_len   <= req_bytes;
+                        hash_start <= 1'b1;
+                        state      <= V_HASH;
+                    end
+                end
+
+                V_HASH: begin
+                    if (hash_done) begin
+                        digest   <= hash_out;
+                        word     <= 3'd0;
+                        mismatch <= 1'b0;
+                        state    <= V_TABLE;
+                    end
+                end
+
+                V_TABLE: begin
+                    if (mem_ready) begin
+                        digest   <= {digest[223:0], 32'h0};
+                        word     <= word + 1'b1;
+                        mismatch <= mismatch || word_bad;
+                        if (word == 3'd7) begin
+                            if (mismatch || word_bad) begin
+                                failed    <= 1'b1;
+                                fail_page <= cur_page;
+                            end
+                            state <= V_IDLE;
+                        end
+                    end
+                end
+
+                default: state <= V_IDLE;
+            endcase
+
+            //---------------------------------------------------------
+            // Handle writes (TABLE/LENGTH are locked once enabled)
+            //---------------------------------------------------------
+            if (we) begin
+                case (addr)
+                    ADDR_CTRL: begin
+                        if (wdata[CTRL_ENABLE])
+                            enabled <= 1'b1;
+                    end
+
+                    ADDR_TABLE: begin
+                        if (!enabled)
+                            table_addr <= wdata;
+                    end
+
+                    ADDR_LENGTH: begin
+                        if (!enabled)
+                            img_len <= wdata;
+                    end
+
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+    //=================================================================
+    // Read Interface
+    //=================================================================
+    always @(*) begin
+        rdata = 32'h0;
+        case (addr)
+            ADDR_CTRL:     rdata[CTRL_ENABLE] = enabled;
+            ADDR_TABLE:    rdata = table_addr;
+            ADDR_LENGTH:   rdata = img_len;
+            ADDR_VERIFIED: rdata = {16'h0, verified};
+            ADDR_STATUS: begin
+                rdata[STATUS_BUSY] = (state != V_IDLE);
+                rdata[STATUS_FAIL] = failed;
+                rdata[11:8]        = fail_page;
+            end
+            default:       rdata = 32'h0;
+        endcase
+    end
+
+endmodule
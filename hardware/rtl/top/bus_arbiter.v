@@ -0,0 +1,85 @@
+/*
+ * Shared Bus Arbiter
+ *
+ * Round-robin arbiter that connects several PicoRV32-style bus masters
+ * (CPU harts, crypto DMA) to the single SoC memory bus.
+ *
+ * All slaves answer in the same cycle (mem_ready = mem_valid), so a
+ * transfer completes in the cycle it is granted. The grant is
+ * combinational from the registered master valid signals; the priority
+ * pointer advances after every completed transfer so no master can
+ * starve another.
+ *
+ * Master ports are flattened vectors: master n uses
+ *   m_addr[n*32 +: 32], m_wdata[n*32 +: 32], m_wstrb[n*4 +: 4]
+ * Read data is shared: route the bus mem_rdata back to every master.
+ */
+
+`timescale 1ns / 1ps
+
+module bus_arbiter #(
+    parameter NUM_MASTERS = 3,
+    parameter ID_WIDTH    = 2      // Must hold NUM_MASTERS-1
+)(
+    input  wire                      clk,
+    input  wire                      rst_n,
+
+    // Master side
+    input  wire [NUM_MASTERS-1:0]    m_valid,
+    input  wire [NUM_MASTERS-1:0]    m_instr,
+    input  wire [NUM_MASTERS*32-1:0] m_addr,
+    input  wire [NUM_MASTERS*32-1:0] m_wdata,
+    input  wire [NUM_MASTERS*4-1:0]  m_wstrb,
+    output wire [NUM_MASTERS-1:0]    m_ready,
+
+    // Shared bus side
+    output reg                       mem_valid,
+    output reg                       mem_instr,
+    output reg  [31:0]               mem_addr,
+    output reg  [31:0]               mem_wdata,
+    output reg  [3:0]                mem_wstrb,
+    input  wire                      mem_ready,
+
+    // Master currently owning the bus (valid while mem_valid)
+    output reg  [ID_WIDTH-1:0]       grant_id
+);
+
+    //=================================================================
+    // Round-Robin Grant
+    //=================================================================
+    reg [ID_WIDTH-1:0] last_grant;
+    reg [ID_WIDTH-1:0] idx;
+    reg                found;
+    integer k;
+
+    always @(*) begin
+        found    = 1'b0;
+        grant_id = last_grant;
+
+        // Search starting after the last master served
+        for (k = 1; k <= NUM_MASTERS; k = k + 1) begin
+            idx = (last_grant + k) % NUM_MASTERS;
+            if (!found && m_valid[idx]) begin
+                found    = 1'b1;
+                grant_id = idx;
+            end
+        end
+
+        mem_valid = found;
+        mem_instr = m_instr[grant_id];
+        mem_addr  = m_addr[grant_id*32 +: 32];
+        mem_wdata = m_wdata[grant_id*32 +: 32];
+        mem_wstrb = found ? m_wstrb[grant_id*4 +: 4] : 4'b0000;
+    end
+
+    assign m_ready = (mem_valid && mem_ready) ? (1 << grant_id) : {NUM_MASTERS{1'b0}};
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            last_grant <= NUM_MASTERS - 1;   // Master 0 wins first
+        end else if (mem_valid && mem_ready) begin
+            last_grant <= grant_id;
+        end
+    end
+
+endmodule
@@ -2,11 +2,14 @@
  * Secure RISC-V SoC - Top Level Module
  * 
  * Integrates:
- *   - PicoRV32 CPU core (RV32I)
+ *   - PicoRV32 CPU core (RV32IMC), optionally a second hart (DUAL_CORE)
+ *   - Round-robin bus arbiter (CPU harts, crypto accelerator, DMA,
+ *     UART TX DMA, firmware page verifier)
  *   - Boot ROM (4KB) - Secure bootloader
  *   - Instruction Memory (64KB) - Application firmware
  *   - Data Memory (64KB) - Stack, heap, variables
  *   - UART - Debug console
+ *   - Instruction trace unit (hart 0)
  *   - Future: MPU, Crypto Accelerator, Key Store
  *
  * Memory Map:
@@ -17,11 +20,32 @@
  *   0x30000000 - 0x300000FF : Crypto Accelerator
  *   0x40000000 - 0x400000FF : Key Store
  *   0x50000000 - 0x500000FF : Anti-Replay Protection
+ *   0x60000000 - 0x600000FF : System Control (IRQ controller, timer,
+ *                             hart ID / hardware mutex, boot status)
+ *   0x70000000 - 0x700000FF : DMA Controller
+ *   0x80000000 - 0x800000FF : Instruction Trace Unit
+ *   0x90000000 - 0x900001FF : MPU region configuration
+ *                             (fault capture at 0x90000040,
+ *                             page verifier at 0x90000060)
+ *
+ * Parameters:
+ *   DUAL_CORE : 1 = instantiate a second PicoRV32 hart sharing all memory
+ *               and peripherals (simulate with DUAL_CORE=1 simulate.sh)
+ *   MPU_LOOKAHEAD : 1 = check CPU accesses one cycle early on mem_la_addr
+ *               and register the result, so the MPU adds no logic
+ *               between mem_addr and the memories for CPU accesses;
+ *               0 = check every access combinationally on mem_addr
+ *   UART_BAUD : UART bit rate (firmware waits for the TX FIFO, so
+ *               simulation uses a fast rate)
  */
 
 `timescale 1ns / 1ps
 
-module soc_top (
+module soc_top #(
+    parameter DUAL_CORE     = 0,
+    parameter MPU_LOOKAHEAD = 1,
+    parameter UART_BAUD     = 115200
+)(
     input  wire clk,
     input  wire rst_n,
     
@@ -39,7 +63,32 @@ module soc_top (
 );
 
     //=================================================================
-    // CPU Memory Interface Signals
+    // Warm Reset
+    //=================================================================
+    // rst_n is the power-on reset. Writing WARM_RESET_KEY to BOOT_RESET
+    // (0x600000A4) pulses sys_rst_n, which resets everything except
+    // instruction memory contents, its verification status and the page
+    // verifier's VERIFIED bitmap (see Boot Status below).
+    localparam [31:0] WARM_RESET_KEY = 32'hB007C0DE;
+    
+    reg  warm_rst;                        // One-cycle warm reset pulse
+    reg  warm_boot;                       // A warm reset has occurred
+    wire warm_rst_req;
+    wire sys_rst_n = rst_n && !warm_rst;
+    
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            warm_rst  <= 1'b0;
+            warm_boot <= 1'b0;
+        end else begin
+            warm_rst  <= warm_rst_req;
+            if (warm_rst)
+                warm_boot <= 1'b1;
+        end
+    end
+    
+    //=================================================================
+    // Shared Bus Signals (bus arbiter output)
     //=================================================================
     wire        mem_valid;
     wire        mem_instr;
@@ -49,6 +98,47 @@ module soc_top (
     wire [3:0]  mem_wstrb;
     wire [31:0] mem_rdata;
     
+    // Bus masters: 0 = hart 0, 1 = hart 1, 2 = crypto accelerator, 3 = DMA,
+    // 4 = UART TX DMA, 5 = firmware page verifier
+    localparam NUM_MASTERS = 6;
+    localparam MASTER_BITS = 3;
+    localparam MASTER_DMA  = 3'd3;
+    localparam MASTER_UART = 3'd4;
+    localparam MASTER_PV   = 3'd5;
+    localparam NUM_HARTS   = DUAL_CORE ? 2 : 1;
+    
+    wire [MASTER_BITS-1:0] bus_master;    // Arbiter grant (valid with mem_valid)
+    
+    wire        cpu0_mem_valid, cpu1_mem_valid;
+    wire        cpu0_mem_instr, cpu1_mem_instr;
+    wire        cpu0_mem_ready, cpu1_mem_ready;
+    wire [31:0] cpu0_mem_addr,  cpu1_mem_addr;
+    wire [31:0] cpu0_mem_wdata, cpu1_mem_wdata;
+    wire [3:0]  cpu0_mem_wstrb, cpu1_mem_wstrb;
+    wire        cpu0_mem_la_read, cpu1_mem_la_read;
+    wire        cpu0_mem_la_write, cpu1_mem_la_write;
+    wire [31:0] cpu0_mem_la_addr, cpu1_mem_la_addr;
+    wire        cpu0_bus_valid, cpu1_bus_valid;   // Held off while MPU permissions are stale
+    
+    wire [31:0] crypto_mem_addr;
+    wire        crypto_mem_valid;
+    wire        crypto_mem_ready;
+    
+    wire        dma_mem_valid;
+    wire        dma_mem_ready;
+    wire [31:0] dma_mem_addr;
+    wire [31:0] dma_mem_wdata;
+    wire [3:0]  dma_mem_wstrb;
+    
+    wire        uart_mem_valid;
+    wire        uart_mem_ready;
+    wire [31:0] uart_mem_addr;
+    
+    wire        pv_mem_valid;
+    wire        pv_mem_ready;
+    wire [31:0] pv_mem_addr;
+    wire [4:0]  pv_hold;          // Masters 0-4 held for an unverified page
+    
     //=================================================================
     // Memory Region Selection
     //=================================================================
@@ -58,6 +148,12 @@ module soc_top (
     wire uart_sel       = (mem_addr >= 32'h20000000 && mem_addr < 32'h20000100);
     wire crypto_sel     = (mem_addr >= 32'h30000000 && mem_addr < 32'h30000100);
     wire anti_replay_sel = (mem_addr >= 32'h50000000 && mem_addr < 32'h50000100);
+    wire sysctrl_sel    = (mem_addr >= 32'h60000000 && mem_addr < 32'h60000100);
+    wire dma_sel        = (mem_addr >= 32'h70000000 && mem_addr < 32'h70000100);
+    wire trace_sel      = (mem_addr >= 32'h80000000 && mem_addr < 32'h80000100);
+    wire mpu_cfg_sel    = (mem_addr >= 32'h90000000 && mem_addr < 32'h90000200);
+    wire mpu_fault_sel  = mpu_cfg_sel && (mem_addr[8:5] == 4'b0010);   // 0x40-0x5F
+    wire pv_sel         = mpu_cfg_sel && (mem_addr[8:5] == 4'b0011);   // 0x60-0x7F
     
     //=================================================================
     // Memory Read Data Signals
@@ -68,34 +164,162 @@ module soc_top (
     wire [31:0] uart_rdata;
     wire [31:0] crypto_rdata;
     wire [31:0] anti_replay_rdata;
+    wire [31:0] sysctrl_rdata;
+    wire [31:0] dma_rdata;
+    wire [31:0] trace_rdata;
+    wire [31:0] mpu_cfg_rdata;
+    wire [31:0] mpu_fault_rdata;
+    wire [31:0] pv_rdata;
     
     //=================================================================
     // Memory Protection Unit (MPU)
     //=================================================================
     wire mpu_violation;
     wire mpu_access_allowed;
+    wire bus_we;                          // Slave write strobe (see below)
     
     // Privilege mode: 0 = user mode, 1 = machine mode
-    // For now, always run in user mode to test MPU
-    // TODO: Connect to actual CPU privilege level when available
-    wire privileged_mode = 1'b0;
-    
-    mpu mpu_inst (
-        .addr(mem_addr),
-        .is_write(|mem_wstrb),           // Any write strobe active?
-        .is_exec(mem_instr),              // Instruction fetch?
-        .privileged_mode(privileged_mode),
-        .violation(mpu_violation),
-        .access_allowed(mpu_access_allowed)
+    // PicoRV32 has no privilege levels, so a hart counts as machine mode
+    // from reset until its first instruction fetch outside the boot ROM.
+    // Privilege is only lost until the next reset: fetching from the ROM
+    // again (the IRQ vector, or a jump into a ROM sequence ending in ret)
+    // does not restore it. The other bus masters are always user mode.
+    reg  cpu0_priv;
+    reg  cpu1_priv;
+    wire privileged_mode = (bus_master == 3'd0) ? cpu0_priv :
+                           (bus_master == 3'd1) ? cpu1_priv : 1'b0;
+    
+    // Privilege including a fetch that completes this cycle
+    wire fetch_done     = mem_valid && mem_ready && mem_instr;
+    wire cpu0_priv_next = (fetch_done && bus_master == 3'd0) ? cpu0_priv && boot_rom_sel : cpu0_priv;
+    wire cpu1_priv_next = (fetch_done && bus_master == 3'd1) ? cpu1_priv && boot_rom_sel : cpu1_priv;
+    
+    always @(posedge clk or negedge sys_rst_n) begin
+        if (!sys_rst_n) begin
+            cpu0_priv <= 1'b1;            // Reset vector is in the boot ROM
+            cpu1_priv <= 1'b1;
+        end else begin
+            cpu0_priv <= cpu0_priv_next;
+            cpu1_priv <= cpu1_priv_next;
+        end
+    end
+    
+    // Address each hart presents next cycle: PicoRV32 loads mem_addr
+    // from mem_la_addr whenever mem_la_read/mem_la_write is set
+    wire [31:0] cpu0_next_addr = (cpu0_mem_la_read || cpu0_mem_la_write) ?
+                                 cpu0_mem_la_addr : cpu0_mem_addr;
+    wire [31:0] cpu1_next_addr = (cpu1_mem_la_read || cpu1_mem_la_write) ?
+                                 cpu1_mem_la_addr : cpu1_mem_addr;
+    
+    // Region table is programmed at 0x90000000 (see mpu.v)
+    // Check ports: 0 = current bus access, 1/2 = hart 0/1 look-ahead
+    wire [2:0] mpu_allow_r;
+    wire [2:0] mpu_allow_w;
+    wire [2:0] mpu_allow_x;
+    wire       mpu_cfg_we = bus_we && mpu_cfg_sel && !mpu_fault_sel && !pv_sel;
+    
+    mpu #(
+        .NUM_REGIONS(16),
+        .NUM_PORTS(3)
+    ) mpu_inst (
+        .clk(clk),
+        .rst_n(sys_rst_n),
+        .cfg_addr(mem_addr[8:2]),
+        .cfg_we(mpu_cfg_we),
+        .cfg_wdata(mem_wdata),
+        .cfg_rdata(mpu_cfg_rdata),
+        .addr({cpu1_next_addr, cpu0_next_addr, mem_addr}),
+        .privileged_mode({cpu1_priv_next, cpu0_priv_next, privileged_mode}),
+        .allow_read(mpu_allow_r),
+        .allow_write(mpu_allow_w),
+        .allow_exec(mpu_allow_x)
     );
     
-    // Generate trap signal when MPU detects violation during valid access
-    wire mpu_trap = mpu_violation && mem_valid;
+    // Combinational check of the access on the bus (crypto and DMA
+    // accesses, and CPU accesses when MPU_LOOKAHEAD = 0)
+    wire bus_mpu_violation = mem_instr   ? !mpu_allow_x[0] :
+                             |mem_wstrb  ? !mpu_allow_w[0] : !mpu_allow_r[0];
+    
+    // Registered look-ahead permissions {X, W, R}, valid for each hart's
+    // mem_addr in the following cycle. A configuration write makes them
+    // stale for one cycle; the harts are held off the bus meanwhile.
+    reg [2:0] cpu0_perm_q;
+    reg [2:0] cpu1_perm_q;
+    reg       cpu_perm_valid;
+    
+    always @(posedge clk or negedge sys_rst_n) begin
+        if (!sys_rst_n) begin
+            cpu0_perm_q    <= 3'b000;
+            cpu1_perm_q    <= 3'b000;
+            cpu_perm_valid <= 1'b0;
+        end else begin
+            cpu0_perm_q    <= {mpu_allow_x[1], mpu_allow_w[1], mpu_allow_r[1]};
+            cpu1_perm_q    <= {mpu_allow_x[2], mpu_allow_w[2], mpu_allow_r[2]};
+            cpu_perm_valid <= !mpu_cfg_we;
+        end
+    end
+    
+    wire cpu0_la_violation = cpu0_mem_instr  ? !cpu0_perm_q[2] :
+                             |cpu0_mem_wstrb ? !cpu0_perm_q[1] : !cpu0_perm_q[0];
+    wire cpu1_la_violation = cpu1_mem_instr  ? !cpu1_perm_q[2] :
+                             |cpu1_mem_wstrb ? !cpu1_perm_q[1] : !cpu1_perm_q[0];
+    
+    assign cpu0_bus_valid = cpu0_mem_valid && (cpu_perm_valid || !MPU_LOOKAHEAD) && !pv_hold[0];
+    assign cpu1_bus_valid = cpu1_mem_valid && (cpu_perm_valid || !MPU_LOOKAHEAD) && !pv_hold[1];
+    
+    // Masters 0/1 are the harts
+    assign mpu_violation = !MPU_LOOKAHEAD     ? bus_mpu_violation :
+                           bus_master == 3'd0 ? cpu0_la_violation :
+                           bus_master == 3'd1 ? cpu1_la_violation :
+                                                bus_mpu_violation;
+    assign mpu_access_allowed = !mpu_violation;
+    
+    // A violating access is always blocked: the write is dropped and a
+    // read returns 0. It is recorded by the fault capture block (System
+    // Control below) and, in its TRAP_EN mode, raises the trap for CPU
+    // accesses. The DMA and the UART see their own violations as
+    // STATUS.ERROR.
+    wire mpu_fault  = mpu_violation && mem_valid;
+    wire dma_fault  = mpu_fault && (bus_master == MASTER_DMA);
+    wire uart_fault = mpu_fault && (bus_master == MASTER_UART);
+    wire mpu_fault_trap_en;
+    wire mpu_trap   = mpu_fault && mpu_fault_trap_en && (bus_master <= 3'd1);
+    
+    // Slave write strobe for the granted transfer
+    assign bus_we = mem_valid && mem_ready && |mem_wstrb && !mpu_violation;
+    
+    // Last instruction fetch per hart (FAULT_PC)
+    reg [31:0] cpu0_fetch_pc;
+    reg [31:0] cpu1_fetch_pc;
+    
+    always @(posedge clk or negedge sys_rst_n) begin
+        if (!sys_rst_n) begin
+            cpu0_fetch_pc <= 32'h00000000;
+            cpu1_fetch_pc <= 32'h00000000;
+        end else if (fetch_done) begin
+            if (bus_master == 3'd0) cpu0_fetch_pc <= mem_addr;
+            if (bus_master == 3'd1) cpu1_fetch_pc <= mem_addr;
+        end
+    end
     
     //=================================================================
-    // PicoRV32 CPU Core
+    // PicoRV32 CPU Core (hart 0)
     //=================================================================
     wire cpu_trap;  // CPU's own trap signal
+    wire cpu1_trap;
+    wire [31:0] cpu_irq;  // From interrupt controller (see System Control)
+    
+    // Peripheral interrupt requests
+    wire uart_irq;
+    wire uart_rx_irq;
+    wire uart_dma_irq;
+    wire crypto_irq;
+    wire replay_irq;
+    wire dma_irq;
+    
+    // Hart 0 instruction trace
+    wire        cpu_trace_valid;
+    wire [35:0] cpu_trace_data;
     
     picorv32 #(
         .ENABLE_COUNTERS(1),
@@ -107,7 +331,7 @@ module soc_top (
         .BARREL_SHIFTER(0),
         .TWO_CYCLE_COMPARE(0),
         .TWO_CYCLE_ALU(0),
-        .COMPRESSED_ISA(0),
+        .COMPRESSED_ISA(1),               // RV32C: smaller images, faster boot hash
         .CATCH_MISALIGN(1),
         .CATCH_ILLINSN(1),
         .ENABLE_PCPI(0),
@@ -117,7 +341,7 @@ module soc_top (
         .ENABLE_IRQ(1),
         .ENABLE_IRQ_QREGS(1),
         .ENABLE_IRQ_TIMER(1),
-        .ENABLE_TRACE(0),
+        .ENABLE_TRACE(1),                 // Feeds the trace unit
         .REGS_INIT_ZERO(1),
         .MASKED_IRQ(32'h00000000),
         .LATCHED_IRQ(32'hffffffff),
@@ -126,22 +350,22 @@ module soc_top (
         .STACKADDR(32'h10010000)          // Stack pointer init (end of 64KB range)
     ) cpu (
         .clk       (clk),
-        .resetn    (rst_n),
+        .resetn    (sys_rst_n),
         .trap      (cpu_trap),
         
-        // Memory Interface
-        .mem_valid (mem_valid),
-        .mem_instr (mem_instr),
-        .mem_ready (mem_ready),
-        .mem_addr  (mem_addr),
-        .mem_wdata (mem_wdata),
-        .mem_wstrb (mem_wstrb),
+        // Memory Interface (through bus arbiter)
+        .mem_valid (cpu0_mem_valid),
+        .mem_instr (cpu0_mem_instr),
+        .mem_ready (cpu0_mem_ready),
+        .mem_addr  (cpu0_mem_addr),
+        .mem_wdata (cpu0_mem_wdata),
+        .mem_wstrb (cpu0_mem_wstrb),
         .mem_rdata (mem_rdata),
         
-        // Look-Ahead Interface (not used)
-        .mem_la_read  (),
-        .mem_la_write (),
-        .mem_la_addr  (),
+        // Look-Ahead Interface (MPU pre-check)
+        .mem_la_read  (cpu0_mem_la_read),
+        .mem_la_write (cpu0_mem_la_write),
+        .mem_la_addr  (cpu0_mem_la_addr),
         .mem_la_wdata (),
         .mem_la_wstrb (),
         
@@ -156,12 +380,121 @@ module soc_top (
         .pcpi_ready   (1'b0),
         
         // IRQ Interface
-        .irq          (32'h00000000),     // No IRQs for now
+        .irq          (cpu_irq),
         .eoi          (),
         
-        // Trace Interface (not used)
-        .trace_valid  (),
-        .trace_data   ()
+        // Trace Interface (to trace unit)
+        .trace_valid  (cpu_trace_valid),
+        .trace_data   (cpu_trace_data)
+    );
+    
+    //=================================================================
+    // PicoRV32 CPU Core (hart 1, DUAL_CORE builds only)
+    //=================================================================
+    // Same configuration as hart 0. It boots from the same ROM, which
+    // parks it until hart 0 writes HART_RELEASE. Peripheral IRQs are
+    // routed to hart 0 only.
+    generate
+        if (DUAL_CORE) begin : gen_cpu1
+            picorv32 #(
+                .ENABLE_COUNTERS(1),
+                .ENABLE_COUNTERS64(1),
+                .ENABLE_REGS_16_31(1),
+                .ENABLE_REGS_DUALPORT(1),
+                .LATCHED_MEM_RDATA(0),
+                .TWO_STAGE_SHIFT(1),
+                .BARREL_SHIFTER(0),
+                .TWO_CYCLE_COMPARE(0),
+                .TWO_CYCLE_ALU(0),
+                .COMPRESSED_ISA(1),
+                .CATCH_MISALIGN(1),
+                .CATCH_ILLINSN(1),
+                .ENABLE_PCPI(0),
+                .ENABLE_MUL(1),
+                .ENABLE_FAST_MUL(0),
+                .ENABLE_DIV(1),
+                .ENABLE_IRQ(1),
+                .ENABLE_IRQ_QREGS(1),
+                .ENABLE_IRQ_TIMER(1),
+                .ENABLE_TRACE(0),
+                .REGS_INIT_ZERO(1),
+                .MASKED_IRQ(32'h00000000),
+                .LATCHED_IRQ(32'hffffffff),
+                .PROGADDR_RESET(32'h00000000),
+                .PROGADDR_IRQ(32'h00000010),
+                .STACKADDR(32'h1000C000)          // Hart 1 stack (see start.S)
+            ) cpu1 (
+                .clk       (clk),
+                .resetn    (sys_rst_n),
+                .trap      (cpu1_trap),
+                
+                .mem_valid (cpu1_mem_valid),
+                .mem_instr (cpu1_mem_instr),
+                .mem_ready (cpu1_mem_ready),
+                .mem_addr  (cpu1_mem_addr),
+                .mem_wdata (cpu1_mem_wdata),
+                .mem_wstrb (cpu1_mem_wstrb),
+                .mem_rdata (mem_rdata),
+                
+                .mem_la_read  (cpu1_mem_la_read),
+                .mem_la_write (cpu1_mem_la_write),
+                .mem_la_addr  (cpu1_mem_la_addr),
+                .mem_la_wdata (),
+                .mem_la_wstrb (),
+                
+                .pcpi_valid   (),
+                .pcpi_insn    (),
+                .pcpi_rs1     (),
+                .pcpi_rs2     (),
+                .pcpi_wr      (1'b0),
+                .pcpi_rd      (32'h00000000),
+                .pcpi_wait    (1'b0),
+                .pcpi_ready   (1'b0),
+                
+                .irq          (32'h00000000),
+                .eoi          (),
+                
+                .trace_valid  (),
+                .trace_data   ()
+            );
+        end else begin : gen_no_cpu1
+            assign cpu1_mem_valid = 1'b0;
+            assign cpu1_mem_instr = 1'b0;
+            assign cpu1_mem_addr  = 32'h00000000;
+            assign cpu1_mem_wdata = 32'h00000000;
+            assign cpu1_mem_wstrb = 4'b0000;
+            assign cpu1_mem_la_read  = 1'b0;
+            assign cpu1_mem_la_write = 1'b0;
+            assign cpu1_mem_la_addr  = 32'h00000000;
+            assign cpu1_trap      = 1'b0;
+        end
+    endgenerate
+    
+    //=================================================================
+    // Bus Arbiter
+    //=================================================================
+    // All masters see the shared mem_rdata; mem_ready is returned only
+    // to the granted master.
+    bus_arbiter #(
+        .NUM_MASTERS(NUM_MASTERS),
+        .ID_WIDTH(MASTER_BITS)
+    ) arbiter_inst (
+        .clk       (clk),
+        .rst_n     (sys_rst_n),
+        .m_valid   ({pv_mem_valid,   uart_mem_valid && !pv_hold[4], dma_mem_valid && !pv_hold[3],
+                     crypto_mem_valid && !pv_hold[2], cpu1_bus_valid, cpu0_bus_valid}),
+        .m_instr   ({1'b0,           1'b0,           1'b0,          1'b0,             cpu1_mem_instr, cpu0_mem_instr}),
+        .m_addr    ({pv_mem_addr,    uart_mem_addr,  dma_mem_addr,  crypto_mem_addr,  cpu1_mem_addr,  cpu0_mem_addr}),
+        .m_wdata   ({32'h00000000,   32'h00000000,   dma_mem_wdata, 32'h00000000,     cpu1_mem_wdata, cpu0_mem_wdata}),
+        .m_wstrb   ({4'b0000,        4'b0000,        dma_mem_wstrb, 4'b0000,          cpu1_mem_wstrb, cpu0_mem_wstrb}),
+        .m_ready   ({pv_mem_ready,   uart_mem_ready, dma_mem_ready, crypto_mem_ready, cpu1_mem_ready, cpu0_mem_ready}),
+        .mem_valid (mem_valid),
+        .mem_instr (mem_instr),
+        .mem_addr  (mem_addr),
+        .mem_wdata (mem_wdata),
+        .mem_wstrb (mem_wstrb),
+        .mem_ready (mem_ready),
+        .grant_id  (bus_master)
     );
     
     //=================================================================
@@ -176,25 +509,23 @@ module soc_top (
     //=================================================================
     // Instruction Memory (64KB) - Application firmware
     //=================================================================
-    // Multiplex address between CPU and crypto accelerator
-    // Address calculation: extract word index from address
-    // For 0x00010000-0x0001FFFF: word_idx = (addr - 0x00010000) >> 2
-    wire [13:0] instr_mem_addr_mux;  // 14 bits for 16K words
-    // Crypto accelerator only reads when it has a valid request
-    wire        crypto_reading_instr = crypto_mem_valid && (crypto_mem_addr >= 32'h00010000 && crypto_mem_addr < 32'h00020000);
-    // Explicitly calculate word index: (addr - base) >> 2
-    wire [31:0] cpu_word_addr = (mem_addr - 32'h00010000) >> 2;
-    wire [31:0] crypto_word_addr = (crypto_mem_addr - 32'h00010000) >> 2;
-    // Only use crypto address if crypto is actively reading, otherwise use CPU address
-    assign instr_mem_addr_mux = crypto_reading_instr ? crypto_word_addr[13:0] : cpu_word_addr[13:0];
-    
+    // The crypto accelerator reads firmware through the bus arbiter,
+    // so IMEM has a single address port like the other memories. Its
+    // verification status is kept across warm resets (Boot Status).
     instruction_mem instr_mem_inst (
-        .clk   (clk),
-        .we    (mem_valid && mem_ready && instr_mem_sel && |mem_wstrb),
-        .addr  (instr_mem_addr_mux),      // Word-addressed (multiplexed)
-        .wdata (mem_wdata),
-        .wstrb (mem_wstrb),
-        .rdata (instr_mem_rdata)
+        .clk          (clk),
+        .por_n        (rst_n),
+        .we           (bus_we && instr_mem_sel),
+        .addr         (mem_addr[15:2]),   // Word-addressed
+        .wdata        (mem_wdata),
+        .wstrb        (mem_wstrb),
+        .rdata        (instr_mem_rdata),
+        .digest_addr  (mem_addr[4:2]),
+        .digest_we    (boot_stat_we && !mem_addr[5]),
+        .digest_wdata (mem_wdata),
+        .digest_rdata (imem_digest_rdata),
+        .mark_clean   (boot_stat_we && mem_addr[5:2] == 4'd8 && mem_wdata[0]),
+        .dirty        (imem_dirty)
     );
     
     //=================================================================
@@ -202,7 +533,7 @@ module soc_top (
     //=================================================================
     data_mem data_mem_inst (
         .clk   (clk),
-        .we    (mem_valid && mem_ready && data_mem_sel && |mem_wstrb),
+        .we    (bus_we && data_mem_sel),
         .addr  (mem_addr[15:2]),          // Word-addressed
         .wdata (mem_wdata),
         .wstrb (mem_wstrb),
@@ -213,59 +544,87 @@ module soc_top (
     // UART Peripheral
     //=================================================================
     // Note: For real hardware, BAUD_RATE should be 115200.
-    // For simulation we now monitor UART at the bus level in the
-    // testbench, so the exact baud rate here is less important.
+    // The testbench monitors UART at the bus level but firmware waits
+    // for room in the TX FIFO, so simulation runs it faster (UART_BAUD).
+    // TX DMA jobs read their buffer as bus master 4.
     uart #(
         .CLK_FREQ(100000000),
-        .BAUD_RATE(115200)
+        .BAUD_RATE(UART_BAUD)
     ) uart_inst (
         .clk   (clk),
-        .rst_n (rst_n),
+        .rst_n (sys_rst_n),
         .addr  (mem_addr[5:2]),
-        .we    (mem_valid && mem_ready && uart_sel && |mem_wstrb),
+        .we    (bus_we && uart_sel),
+        .re    (mem_valid && mem_ready && uart_sel && !(|mem_wstrb) && !mpu_violation),
         .wdata (mem_wdata),
         .rdata (uart_rdata),
+        .mem_valid (uart_mem_valid),
+        .mem_addr  (uart_mem_addr),
+        .mem_rdata (mem_rdata),
+        .mem_ready (uart_mem_ready),
+        .mem_error (uart_fault),
         .tx    (uart_tx),
-        .rx    (uart_rx)
+        .rx    (uart_rx),
+        .irq   (uart_irq),
+        .irq_rx(uart_rx_irq),
+        .irq_dma(uart_dma_irq)
     );
     
     //=================================================================
     // Crypto Accelerator (SHA-256, HMAC)
     //=================================================================
-    wire [31:0] crypto_mem_addr;
-    wire        crypto_mem_valid;
-    wire [31:0] crypto_mem_rdata;
-    wire        crypto_mem_ready;
-    
-    // Crypto needs to read firmware from instruction memory
-    // Route its memory requests appropriately
-    assign crypto_mem_rdata = (crypto_mem_addr >= 32'h00010000 && crypto_mem_addr < 32'h00020000) ? 
-                               instr_mem_rdata : 32'h0;
-    assign crypto_mem_ready = 1'b1;  // Instant response for now
-    
-    crypto_accelerator crypto_inst (
+    // Crypto reads its message (firmware, packets) as bus master 2.
+    // Packet mode hands authenticated packets to the anti-replay engine.
+    wire        pkt_replay_req;
+    wire [7:0]  pkt_replay_ctx;
+    wire [31:0] pkt_replay_counter;
+    wire [31:0] pkt_replay_nonce;
+    wire        pkt_replay_done;
+    wire [3:0]  pkt_replay_status;
+
+    localparam REPLAY_CONTEXTS = 32;
+    localparam REPLAY_CTX_BITS = 5;
+
+    crypto_accelerator #(
+        .REPLAY_CONTEXTS(REPLAY_CONTEXTS)
+    ) crypto_inst (
         .clk        (clk),
-        .rst_n      (rst_n),
+        .rst_n      (sys_rst_n),
         .addr       (mem_addr[9:2]),  // 8 bits for address
-        .we         (mem_valid && mem_ready && crypto_sel && |mem_wstrb),
+        .we         (bus_we && crypto_sel),
         .wdata      (mem_wdata),
         .rdata      (crypto_rdata),
         .mem_addr   (crypto_mem_addr),
         .mem_valid  (crypto_mem_valid),
-        .mem_rdata  (crypto_mem_rdata),
-        .mem_ready  (crypto_mem_ready)
+        .mem_rdata  (mem_rdata),
+        .mem_ready  (crypto_mem_ready),
+        .replay_req     (pkt_replay_req),
+        .replay_ctx     (pkt_replay_ctx),
+        .replay_counter (pkt_replay_counter),
+        .replay_nonce   (pkt_replay_nonce),
+        .replay_done    (pkt_replay_done),
+        .replay_status  (pkt_replay_status),
+        .irq        (crypto_irq)
     );
     
     //=================================================================
     // Anti-Replay Protection Modules
     //=================================================================
-    // Monotonic Counter (0x50000000 - 0x5000000F)
+    // Monotonic Counter (0x50000000 - 0x5000000F, fetch-and-add and
+    // 64-bit registers at 0x50000080 - 0x5000008F, version floor at
+    // 0x50000090 - 0x5000009F)
     wire [31:0] counter_rdata;
-    monotonic_counter counter_inst (
+    wire        counter_sel = anti_replay_sel && ((mem_addr[6:4] == 3'h0) ||
+                                                  (mem_addr[7:4] == 4'h9));
+    monotonic_counter #(
+        .COUNTER_WIDTH(64)
+    ) counter_inst (
         .clk   (clk),
-        .rst_n (rst_n),
-        .addr  (mem_addr[3:0]),
-        .we    (mem_valid && mem_ready && anti_replay_sel && (mem_addr[7:4] == 4'h0) && |mem_wstrb),
+        .rst_n (sys_rst_n),
+        .por_n (rst_n),
+        .addr  ({mem_addr[7] && mem_addr[4], mem_addr[7] && !mem_addr[4], mem_addr[3:0]}),
+        .we    (bus_we && counter_sel),
+        .re    (mem_valid && mem_ready && counter_sel && !(|mem_wstrb) && !mpu_violation),
         .wdata (mem_wdata),
         .rdata (counter_rdata)
     );
@@ -274,50 +633,261 @@ module soc_top (
     wire [31:0] nonce_rdata;
     nonce_gen nonce_inst (
         .clk   (clk),
-        .rst_n (rst_n),
+        .rst_n (sys_rst_n),
         .addr  (mem_addr[3:0]),
-        .we    (mem_valid && mem_ready && anti_replay_sel && (mem_addr[7:4] == 4'h1) && |mem_wstrb),
+        .we    (bus_we && anti_replay_sel && (mem_addr[7:4] == 4'h1)),
+        .re    (mem_valid && mem_ready && anti_replay_sel && (mem_addr[7:4] == 4'h1) &&
+                !(|mem_wstrb) && !mpu_violation),
         .wdata (mem_wdata),
         .rdata (nonce_rdata)
     );
     
-    // Anti-Replay Engine (0x50000020 - 0x5000003F)
+    // Anti-Replay Engine (0x50000020 - 0x5000007F)
     wire [31:0] replay_rdata;
-    anti_replay replay_inst (
+    wire        replay_sel = anti_replay_sel && !mem_addr[7] && (mem_addr[6:5] != 2'b00);
+    anti_replay #(
+        .NUM_CONTEXTS(REPLAY_CONTEXTS),
+        .CTX_BITS(REPLAY_CTX_BITS)
+    ) replay_inst (
         .clk   (clk),
-        .rst_n (rst_n),
-        .addr  (mem_addr[4:0]),
-        .we    (mem_valid && mem_ready && anti_replay_sel && (mem_addr[7:5] == 3'b001) && |mem_wstrb),
+        .rst_n (sys_rst_n),
+        .addr  (mem_addr[6:0] - 7'h20),
+        .we    (bus_we && replay_sel),
+        .re    (mem_valid && mem_ready && replay_sel && !(|mem_wstrb) && !mpu_violation),
         .wdata (mem_wdata),
-        .rdata (replay_rdata)
+        .rdata (replay_rdata),
+        .pkt_req     (pkt_replay_req),
+        .pkt_ctx     (pkt_replay_ctx),
+        .pkt_counter (pkt_replay_counter),
+        .pkt_nonce   (pkt_replay_nonce),
+        .pkt_done    (pkt_replay_done),
+        .pkt_status  (pkt_replay_status),
+        .irq   (replay_irq)
     );
     
     // Anti-replay read multiplexer
-    assign anti_replay_rdata = (mem_addr[7:4] == 4'h0) ? counter_rdata :
+    assign anti_replay_rdata = counter_sel ? counter_rdata :
                                (mem_addr[7:4] == 4'h1) ? nonce_rdata :
-                               (mem_addr[7:5] == 3'b001) ? replay_rdata :
+                               replay_sel ? replay_rdata :
                                32'h00000000;
     
+    //=================================================================
+    // System Control (0x60000000 - 0x600000FF)
+    //=================================================================
+    // Interrupt Controller (0x60000000 - 0x6000001F)
+    // Sources are latched and forwarded to CPU irq[IRQ_EXT_BASE + n];
+    // irq[0..2] stay reserved for the PicoRV32 internal timer,
+    // EBREAK/illegal instruction and bus error.
+    localparam IRQ_EXT_BASE = 3;
+    localparam IRQ_NUM_SRC  = 8;
+    
+    wire [IRQ_NUM_SRC-1:0] irq_src;
+    wire [IRQ_NUM_SRC-1:0] irq_lines;
+    wire [31:0] irqc_rdata;
+    wire        timer_irq;
+    
+    assign irq_src = {uart_dma_irq,      // 7: UART TX DMA done
+                      uart_rx_irq,       // 6: UART RX data available
+                      mpu_fault_irq,     // 5: MPU violation recorded
+                      dma_irq,           // 4: DMA transfer done
+                      replay_irq,        // 3: anti-replay validation done
+                      crypto_irq,        // 2: crypto operation done
+                      uart_irq,          // 1: UART TX below threshold
+                      timer_irq};        // 0: timer compare match
+    
+    assign cpu_irq = {{(32-IRQ_NUM_SRC-IRQ_EXT_BASE){1'b0}}, irq_lines, {IRQ_EXT_BASE{1'b0}}};
+    
+    irq_ctrl #(
+        .NUM_SRC(IRQ_NUM_SRC)
+    ) irqc_inst (
+        .clk     (clk),
+        .rst_n   (sys_rst_n),
+        .addr    (mem_addr[4:2]),
+        .we      (bus_we && sysctrl_sel && (mem_addr[7:5] == 3'b000)),
+        .wdata   (mem_wdata),
+        .rdata   (irqc_rdata),
+        .irq_src (irq_src),
+        .irq_out (irq_lines)
+    );
+    
+    // Timer (0x60000020 - 0x6000003F)
+    wire [31:0] timer_rdata;
+    timer timer_inst (
+        .clk   (clk),
+        .rst_n (sys_rst_n),
+        .addr  (mem_addr[4:2]),
+        .we    (bus_we && sysctrl_sel && (mem_addr[7:5] == 3'b001)),
+        .wdata (mem_wdata),
+        .rdata (timer_rdata),
+        .irq   (timer_irq)
+    );
+    
+    // Boot Status (0x60000080 - 0x600000BF)
+    //   0x80-0x9C: IMEM_DIGEST - signature recorded by the boot ROM
+    //   0xA0:      BOOT_STATUS - 0: IMEM_DIRTY, 1: WARM (write 1 to bit 0
+    //                            marks instruction memory verified)
+    //   0xA4:      BOOT_RESET  - write WARM_RESET_KEY for a warm reset
+    // IMEM_DIGEST and BOOT_STATUS writes are accepted in machine mode
+    // only (from the boot ROM), so firmware cannot fake a clean image.
+    wire        boot_stat_sel = sysctrl_sel && (mem_addr[7:6] == 2'b10);
+    wire        boot_stat_we  = bus_we && boot_stat_sel && privileged_mode;
+    wire [31:0] imem_digest_rdata;
+    wire        imem_dirty;
+    wire [31:0] boot_stat_rdata = !mem_addr[5]           ? imem_digest_rdata :
+                                  (mem_addr[4:2] == 3'd0) ? {30'h0, warm_boot, imem_dirty} :
+                                                            32'h00000000;
+    
+    assign warm_rst_req = bus_we && boot_stat_sel && (mem_addr[5:2] == 4'd9) &&
+                          (mem_wdata == WARM_RESET_KEY);
+    
+    // Hart ID / Hardware Mutex (0x60000040 - 0x6000007F)
+    // HART_ID and mutex ownership come from the arbiter grant index
+    wire [31:0] mutex_rdata;
+    wire        mutex_sel = sysctrl_sel && (mem_addr[7:6] == 2'b01);
+    hw_mutex #(
+        .NUM_HARTS(NUM_HARTS),
+        .NUM_MUTEX(8),
+        .ID_WIDTH(MASTER_BITS)
+    ) mutex_inst (
+        .clk     (clk),
+        .rst_n   (sys_rst_n),
+        .addr    (mem_addr[5:2]),
+        .we      (bus_we && mutex_sel),
+        .re      (mem_valid && mem_ready && mutex_sel && !(|mem_wstrb) && !mpu_violation),
+        .wdata   (mem_wdata),
+        .rdata   (mutex_rdata),
+        .hart_id (bus_master)
+    );
+    
+    // System control read multiplexer
+    assign sysctrl_rdata = (mem_addr[7:5] == 3'b000) ? irqc_rdata :
+                           (mem_addr[7:5] == 3'b001) ? timer_rdata :
+                           (mem_addr[7:6] == 2'b01)  ? mutex_rdata :
+                           (mem_addr[7:6] == 2'b10)  ? boot_stat_rdata :
+                           32'h00000000;
+    
+    //=================================================================
+    // DMA Controller (0x70000000 - 0x700000FF)
+    //=================================================================
+    // Copies and fills memory as bus master 3 (used by start.S to set up
+    // .data/.bss)
+    dma dma_inst (
+        .clk       (clk),
+        .rst_n     (sys_rst_n),
+        .addr      (mem_addr[4:2]),
+        .we        (bus_we && dma_sel),
+        .wdata     (mem_wdata),
+        .rdata     (dma_rdata),
+        .mem_valid (dma_mem_valid),
+        .mem_addr  (dma_mem_addr),
+        .mem_wdata (dma_mem_wdata),
+        .mem_wstrb (dma_mem_wstrb),
+        .mem_rdata (mem_rdata),
+        .mem_ready (dma_mem_ready),
+        .mem_error (dma_fault),
+        .irq       (dma_irq)
+    );
+    
+    //=================================================================
+    // Instruction Trace Unit (0x80000000 - 0x800000FF)
+    //=================================================================
+    // Records hart 0 branch targets (and optionally load/store addresses
+    // and register writes); freezes on trap for post-mortem decoding
+    trace_unit #(
+        .DEPTH(256),
+        .ADDR_WIDTH(8)
+    ) trace_inst (
+        .clk         (clk),
+        .rst_n       (sys_rst_n),
+        .addr        (mem_addr[5:2]),
+        .we          (bus_we && trace_sel),
+        .wdata       (mem_wdata),
+        .rdata       (trace_rdata),
+        .trace_valid (cpu_trace_valid),
+        .trace_data  (cpu_trace_data),
+        .trap        (trap)
+    );
+    
+    //=================================================================
+    // MPU Fault Capture (0x90000040 - 0x9000005F)
+    //=================================================================
+    wire mpu_fault_irq;
+    mpu_fault mpu_fault_inst (
+        .clk          (clk),
+        .rst_n        (sys_rst_n),
+        .addr         (mem_addr[4:2]),
+        .we           (bus_we && mpu_fault_sel),
+        .wdata        (mem_wdata),
+        .rdata        (mpu_fault_rdata),
+        .fault        (mpu_fault),
+        .fault_addr   (mem_addr),
+        .fault_write  (|mem_wstrb),
+        .fault_exec   (mem_instr),
+        .fault_priv   (privileged_mode),
+        .fault_master (bus_master),
+        .fault_pc     (bus_master == 3'd1 ? cpu1_fetch_pc : cpu0_fetch_pc),
+        .trap_en      (mpu_fault_trap_en),
+        .irq          (mpu_fault_irq)
+    );
+    
+    //=================================================================
+    // Firmware Page Verifier (0x90000060 - 0x9000007F)
+    //=================================================================
+    // Holds masters 0-4 off the bus while they access a firmware page
+    // that has not been checked against its signed digest yet; hashes
+    // the page as bus master 5. Enabled by the boot ROM.
+    wire pv_fail;
+    page_verifier #(
+        .NUM_PORTS(5)
+    ) pv_inst (
+        .clk       (clk),
+        .rst_n     (sys_rst_n),
+        .por_n     (rst_n),
+        .imem_write(bus_we && instr_mem_sel),
+        .addr      (mem_addr[4:2]),
+        .we        (bus_we && pv_sel),
+        .wdata     (mem_wdata),
+        .rdata     (pv_rdata),
+        .chk_valid ({uart_mem_valid, dma_mem_valid, crypto_mem_valid, cpu1_mem_valid, cpu0_mem_valid}),
+        .chk_addr  ({uart_mem_addr,  dma_mem_addr,  crypto_mem_addr,  cpu1_mem_addr,  cpu0_mem_addr}),
+        .hold      (pv_hold),
+        .mem_valid (pv_mem_valid),
+        .mem_addr  (pv_mem_addr),
+        .mem_rdata (mem_rdata),
+        .mem_ready (pv_mem_ready),
+        .fail      (pv_fail)
+    );
+    
     //=================================================================
     // Memory Read Multiplexer
     //=================================================================
-    assign mem_rdata = boot_rom_sel   ? boot_rom_rdata :
+    // Blocked (MPU violation) reads return 0
+    assign mem_rdata = mpu_violation  ? 32'h00000000 :
+                       boot_rom_sel   ? boot_rom_rdata :
                        instr_mem_sel  ? instr_mem_rdata :
                        data_mem_sel   ? data_mem_rdata :
                        uart_sel       ? uart_rdata :
                        crypto_sel     ? crypto_rdata :
                        anti_replay_sel ? anti_replay_rdata :
+                       sysctrl_sel    ? sysctrl_rdata :
+                       dma_sel        ? dma_rdata :
+                       trace_sel      ? trace_rdata :
+                       mpu_fault_sel  ? mpu_fault_rdata :
+                       pv_sel         ? pv_rdata :
+                       mpu_cfg_sel    ? mpu_cfg_rdata :
                        32'h00000000;
     
     //=================================================================
     // Memory Ready Signal (single-cycle memory for now)
     //=================================================================
+    // Slaves respond in the same cycle; the arbiter forwards ready to
+    // the granted master.
     assign mem_ready = mem_valid;
     
     //=================================================================
-    // Trap Signal (CPU trap OR MPU violation)
+    // Trap Signal (CPU trap OR MPU violation OR bad firmware page)
     //=================================================================
-    assign trap = cpu_trap || mpu_trap;
+    assign trap = cpu_trap || cpu1_trap || mpu_trap || pv_fail;
     
     //=================================================================
     // Debug Outputs
@@ -329,8 +899,8 @@ module soc_top (
     // Status LED (blinks on activity)
     //=================================================================
     reg [25:0] led_counter;
-    always @(posedge clk or negedge rst_n) begin
-        if (!rst_n)
+    always @(posedge clk or negedge sys_rst_n) begin
+        if (!sys_rst_n)
             led_counter <= 0;
         else if (mem_valid)
             led_counter <= led_counter + 1;
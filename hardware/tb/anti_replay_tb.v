@@ -5,12 +5,21 @@ module anti_replay_tb;
     // Inputs
     reg clk;
     reg rst_n;
-    reg [4:0] addr;
+    reg [6:0] addr;
     reg we;
     reg [31:0] wdata;
+    reg re;
+
+    // Packet port (driven like the crypto accelerator's P_REPLAY)
+    reg        pkt_req;
+    reg [7:0]  pkt_ctx;
+    reg [31:0] pkt_counter;
+    reg [31:0] pkt_nonce;
 
     // Outputs
     wire [31:0] rdata;
+    wire        pkt_done;
+    wire [3:0]  pkt_status;
 
     // Instantiate the Unit Under Test (UUT)
     anti_replay uut (
@@ -18,21 +27,47 @@ module anti_replay_tb;
         .rst_n(rst_n),
         .addr(addr),
         .we(we),
+        .re(re),
         .wdata(wdata),
-        .rdata(rdata)
+        .rdata(rdata),
+        .pkt_req(pkt_req),
+        .pkt_ctx(pkt_ctx),
+        .pkt_counter(pkt_counter),
+        .pkt_nonce(pkt_nonce),
+        .pkt_done(pkt_done),
+        .pkt_status(pkt_status),
+        .irq()
     );
 
+    // Packet checks seen by the pipeline and pkt_done pulses
+    integer pkt_checks = 0;
+    integer pkt_dones  = 0;
+
+    always @(posedge clk) begin
+        if (uut.state == uut.S_CHECK && uut.chk_pkt)
+            pkt_checks = pkt_checks + 1;
+        if (pkt_done)
+            pkt_dones = pkt_dones + 1;
+    end
+
     // Clock generation
     always #5 clk = ~clk;
 
     // Register constants
-    localparam ADDR_LAST_COUNTER  = 5'h00;
-    localparam ADDR_CHECK_COUNTER = 5'h04;
-    localparam ADDR_CHECK_NONCE   = 5'h08;
-    localparam ADDR_VALIDATE      = 5'h0C;
-    localparam ADDR_STATUS        = 5'h10;
-    localparam ADDR_CACHE_SIZE    = 5'h14;
-    localparam ADDR_CTRL          = 5'h18;
+    localparam ADDR_LAST_COUNTER  = 7'h00;
+    localparam ADDR_CHECK_COUNTER = 7'h04;
+    localparam ADDR_CHECK_NONCE   = 7'h08;
+    localparam ADDR_VALIDATE      = 7'h0C;
+    localparam ADDR_STATUS        = 7'h10;
+    localparam ADDR_CACHE_SIZE    = 7'h14;
+    localparam ADDR_CTRL          = 7'h18;
+    localparam ADDR_CONTEXT_ID    = 7'h24;
+    localparam ADDR_REQ_PUSH      = 7'h2C;
+    localparam ADDR_RESULT_POP    = 7'h30;
+
+    localparam BATCH_DEPTH        = 32;
+
+    integer i;
 
     initial begin
         // Initialize Inputs
@@ -40,7 +75,12 @@ module anti_replay_tb;
         rst_n = 0;
         addr = 0;
         we = 0;
+        re = 0;
         wdata = 0;
+        pkt_req = 0;
+        pkt_ctx = 0;
+        pkt_counter = 0;
+        pkt_nonce = 0;
 
         $dumpfile("anti_replay.vcd");
         $dumpvars(0, anti_replay_tb);
@@ -60,7 +100,7 @@ module anti_replay_tb;
         write_reg(ADDR_CHECK_COUNTER, 1);
         write_reg(ADDR_CHECK_NONCE, 32'hAAAA);
         write_reg(ADDR_VALIDATE, 1);
-        #20;
+        wait_ready;
         verify_status(1); // STATUS_VALID = 0th bit (1)
 
         // Test 2: Replay same packet (should fail)
@@ -68,7 +108,7 @@ module anti_replay_tb;
         write_reg(ADDR_CHECK_COUNTER, 1);
         write_reg(ADDR_CHECK_NONCE, 32'hAAAA);
         write_reg(ADDR_VALIDATE, 1);
-        #20;
+        wait_ready;
         // Logic: 0xAAAA found (Bad Nonce), 1 > 1 False (Bad Counter)
         // Bits: REPLAY(1) | BAD_COUNTER(2) | BAD_NONCE(3)
         // Val: 2 + 4 + 8 = 14
@@ -79,7 +119,7 @@ module anti_replay_tb;
         write_reg(ADDR_CHECK_COUNTER, 0);
         write_reg(ADDR_CHECK_NONCE, 32'hBBBB); // New nonce
         write_reg(ADDR_VALIDATE, 1);
-        #20;
+        wait_ready;
         // Logic: 0 > 1 False (Bad Counter)
         // Nonce Fresh (True)
         // Bits: REPLAY(1) | BAD_COUNTER(2)
@@ -91,14 +131,98 @@ module anti_replay_tb;
         write_reg(ADDR_CHECK_COUNTER, 2);
         write_reg(ADDR_CHECK_NONCE, 32'hBBBB);
         write_reg(ADDR_VALIDATE, 1);
-        #20;
+        wait_ready;
         verify_status(1); // STATUS_VALID = 1
 
+        // Sliding window mode, nonce store bypassed
+        write_reg(ADDR_CTRL, 32'hE); // Reset State | WINDOW | NONCE_OFF
+
+        $display("Test 5: Window - counter 10 then 8 (out of order)");
+        check_packet(10, 0);
+        verify_status(1);
+        check_packet(8, 0);
+        verify_status(1);
+
+        $display("Test 6: Window - replay of 8 inside the window");
+        check_packet(8, 0);
+        verify_status(6); // REPLAY | BAD_COUNTER
+
+        $display("Test 7: Window - jump to 200, 10 falls out of the window");
+        check_packet(200, 0);
+        verify_status(1);
+        check_packet(10, 0);
+        verify_status(6);
+        check_packet(199, 0);
+        verify_status(1);
+
+        $display("Test 8: Packet port - one check and one done per request");
+        send_packet(300, 0);
+        repeat (20) @(posedge clk);
+        if (pkt_checks == 1 && pkt_dones == 1 && pkt_status == 4'd1)
+            $display("  PASS: 1 check, 1 pkt_done, status VALID");
+        else
+            $display("  FAIL: %0d checks, %0d pkt_done, status %0d",
+                     pkt_checks, pkt_dones, pkt_status);
+
+        $display("Test 9: Batch - a full result FIFO pauses the batch");
+        for (i = 0; i <= BATCH_DEPTH; i = i + 1)
+            push_tuple(0, 1000 + i, 32'h5000 + i);
+        repeat (20) @(posedge clk);
+        read_reg(ADDR_LAST_COUNTER);
+        if (uut.req_count == 1 && uut.res_count == BATCH_DEPTH &&
+            !uut.batch_overflow && rdata == 1000 + BATCH_DEPTH - 1)
+            $display("  PASS: last tuple waits, not committed");
+        else
+            $display("  FAIL: %0d queued, %0d results, overflow %0d, last counter %0d",
+                     uut.req_count, uut.res_count, uut.batch_overflow, rdata);
+        pop_result;
+        repeat (20) @(posedge clk);
+        read_reg(ADDR_LAST_COUNTER);
+        if (uut.req_count == 0 && uut.res_count == BATCH_DEPTH &&
+            !uut.batch_overflow && rdata == 1000 + BATCH_DEPTH)
+            $display("  PASS: checked once a result was read");
+        else
+            $display("  FAIL: %0d queued, %0d results, overflow %0d, last counter %0d",
+                     uut.req_count, uut.res_count, uut.batch_overflow, rdata);
+
+        // Context 33 would alias context 1 in 5 bits
+        $display("Test 10: Batch - out-of-range context is not committed");
+        write_reg(ADDR_CTRL, 32'h20);            // FLUSH
+        push_tuple(33, 50, 32'h7000);
+        push_tuple(1, 50, 32'h7001);
+        repeat (20) @(posedge clk);
+        read_reg(ADDR_RESULT_POP);
+        if (rdata[9:8] == 2'b11 && rdata[3:0] == 4'h0)
+            $display("  PASS: context 33 reported BAD_CONTEXT");
+        else
+            $display("  FAIL: result %h", rdata);
+        pop_result;
+        read_reg(ADDR_RESULT_POP);
+        if (rdata[9:8] == 2'b01 && rdata[3:0] == 4'h1 && rdata[23:16] == 8'd1)
+            $display("  PASS: context 1 untouched, counter 50 accepted");
+        else
+            $display("  FAIL: result %h", rdata);
+        pop_result;
+
+        $display("Test 11: Packet port - out-of-range context is not committed");
+        pkt_ctx = 8'd33;
+        send_packet(400, 32'h7002);
+        pkt_ctx = 8'd0;
+        repeat (20) @(posedge clk);
+        write_reg(ADDR_CONTEXT_ID, 1);
+        repeat (2) @(posedge clk);
+        read_reg(ADDR_LAST_COUNTER);
+        if (pkt_dones == 2 && pkt_status == 4'h0 && rdata == 50)
+            $display("  PASS: refused, context 1 LAST_COUNTER still 50");
+        else
+            $display("  FAIL: %0d pkt_done, status %0d, context 1 LAST_COUNTER %0d",
+                     pkt_dones, pkt_status, rdata);
+
         $finish;
     end
 
     task write_reg;
-        input [4:0] reg_addr;
+        input [6:0] reg_addr;
         input [31:0] val;
         begin
             @(posedge clk);
@@ -110,6 +234,82 @@ module anti_replay_tb;
         end
     endtask
 
+    task read_reg;
+        input [6:0] reg_addr;
+        begin
+            @(posedge clk);
+            addr = reg_addr;
+            #1;
+        end
+    endtask
+
+    // One batch tuple: context, counter, nonce
+    task push_tuple;
+        input [31:0] ctx;
+        input [31:0] counter;
+        input [31:0] nonce;
+        begin
+            write_reg(ADDR_REQ_PUSH, ctx);
+            write_reg(ADDR_REQ_PUSH, counter);
+            write_reg(ADDR_REQ_PUSH, nonce);
+        end
+    endtask
+
+    task pop_result;
+        begin
+            @(posedge clk);
+            addr = ADDR_RESULT_POP;
+            re = 1;
+            @(posedge clk);
+            re = 0;
+        end
+    endtask
+
+    task check_packet;
+        input [31:0] counter;
+        input [31:0] nonce;
+        begin
+            write_reg(ADDR_CHECK_COUNTER, counter);
+            write_reg(ADDR_CHECK_NONCE, nonce);
+            write_reg(ADDR_VALIDATE, 1);
+            wait_ready;
+        end
+    endtask
+
+    // Hold pkt_req until pkt_done is sampled, then drop it (as the
+    // crypto accelerator does in P_REPLAY)
+    task send_packet;
+        input [31:0] counter;
+        input [31:0] nonce;
+        begin
+            @(posedge clk);
+            pkt_counter <= counter;
+            pkt_nonce   <= nonce;
+            pkt_req     <= 1'b1;
+            @(posedge clk);
+            #1;
+            while (!pkt_done) begin
+                @(posedge clk);
+                #1;
+            end
+            @(posedge clk);
+            pkt_req <= 1'b0;
+        end
+    endtask
+
+    // Checks take a few cycles: poll STATUS.READY (bit 4)
+    task wait_ready;
+        begin
+            @(posedge clk);
+            addr = ADDR_STATUS;
+            #1;
+            while (!rdata[4]) begin
+                @(posedge clk);
+                #1;
+            end
+        end
+    endtask
+
     // Function replaced with direct access in the test logic or verify task
     task verify_status;
         input [31:0] expected;
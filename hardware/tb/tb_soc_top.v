@@ -10,7 +10,9 @@
 
 `timescale 1ns / 1ps
 
-module tb_soc_top;
+module tb_soc_top #(
+    parameter DUAL_CORE = 0     // Set with iverilog -Ptb_soc_top.DUAL_CORE=1
+);
 
     //=================================================================
     // Clock and Reset
@@ -25,6 +27,7 @@ module tb_soc_top;
     // DUT Signals
     //=================================================================
     wire uart_tx;
+    reg  uart_rx = 1'b1;
     wire [31:0] debug_pc;
     wire [31:0] debug_insn;
     wire trap;
@@ -33,44 +36,113 @@ module tb_soc_top;
     //=================================================================
     // Instantiate DUT
     //=================================================================
-    soc_top dut (
+    soc_top #(
+        .DUAL_CORE(DUAL_CORE),
+        .UART_BAUD(6250000)     // 16 clocks per bit
+    ) dut (
         .clk        (clk),
         .rst_n      (rst_n),
         .uart_tx    (uart_tx),
-        .uart_rx    (1'b1),
+        .uart_rx    (uart_rx),
         .debug_pc   (debug_pc),
         .debug_insn (debug_insn),
         .trap       (trap),
         .status_led (status_led)
     );
     
+    //=================================================================
+    // UART Serial Driver (host to device)
+    //=================================================================
+    // Drives the rx line like a host terminal, at the bit time the UART
+    // is currently programmed for (BAUD_DIV), so firmware can change the
+    // rate before asking for data. On ENQ the host sends UART_RX_MSG
+    // (test_irq checks the same string). On SYN it sends a firmware
+    // update (common/update.h): the signed image currently in
+    // instruction memory, as a 32-bit length and then the bytes.
+    localparam UART_RX_MSG     = "HELLO RX";
+    localparam UART_RX_MSG_LEN = 8;
+
+    event uart_rx_request;
+    event update_request;
+
+    task uart_rx_send;
+        input [7:0] data;
+        integer bit_clks;
+        integer i;
+        begin
+            bit_clks = dut.uart_inst.baud_div;
+            uart_rx = 1'b0;                         // Start bit
+            repeat (bit_clks) @(posedge clk);
+            for (i = 0; i < 8; i = i + 1) begin     // LSB first
+                uart_rx = data[i];
+                repeat (bit_clks) @(posedge clk);
+            end
+            uart_rx = 1'b1;                         // Stop bit
+            repeat (bit_clks) @(posedge clk);
+        end
+    endtask
+
+    always @(uart_rx_request) begin : uart_rx_host
+        integer n;
+        for (n = UART_RX_MSG_LEN - 1; n >= 0; n = n - 1)
+            uart_rx_send(UART_RX_MSG[n*8 +: 8]);
+    end
+
+    always @(update_request) begin : update_host
+        integer hdr_off;
+        integer total;
+        integer n;
+        reg [31:0] word;
+        // Image, page table and header: header offset at +0x08
+        hdr_off = dut.instr_mem_inst.mem[2];
+        total   = hdr_off + 64;
+        $display("\n[SIM] Update: sending %0d bytes", total);
+        for (n = 0; n < 4; n = n + 1)
+            uart_rx_send(total >> (n * 8));
+        for (n = 0; n < total; n = n + 1) begin
+            word = dut.instr_mem_inst.mem[n / 4];
+            uart_rx_send(word >> ((n % 4) * 8));
+        end
+    end
+
     //=================================================================
     // UART Monitor (bus-level, fast for simulation)
     //=================================================================
     integer uart_char_count = 0;
     
     // Instead of decoding the serial TX line (slow in simulation),
-    // we snoop the memory bus and print whenever the CPU writes
-    // to the UART TX register at 0x20000000. This is equivalent to
-    // what the real UART does, but much faster to simulate.
+    // we print every character the UART queues for transmission:
+    // CPU writes to the TX register at 0x20000000 and bytes from a
+    // UART TX DMA job. Taken from the TX FIFO push, so a write the
+    // UART drops (FIFO full) is not printed, as it is never sent.
+    wire uart_cpu_char = dut.uart_inst.cpu_push;
+    wire uart_dma_char = dut.uart_inst.dma_push;
+    wire [7:0] uart_char = uart_cpu_char ? dut.uart_inst.wdata[7:0] : dut.uart_inst.dma_byte;
+
     always @(posedge clk) begin
-        if (rst_n &&
-            dut.mem_valid && dut.mem_ready &&
-            dut.uart_sel && |dut.mem_wstrb) begin
+        if (rst_n && (uart_cpu_char || uart_dma_char)) begin
             
-            // Print lowest byte of wdata as a character
-            if (dut.mem_wdata[7:0] >= 32 && dut.mem_wdata[7:0] < 127) begin
-                $write("%c", dut.mem_wdata[7:0]);
-            end else if (dut.mem_wdata[7:0] == 8'h0A) begin
+            // Print the character
+            if (uart_char >= 32 && uart_char < 127) begin
+                $write("%c", uart_char);
+            end else if (uart_char == 8'h0A) begin
                 $write("\n");
-            end else if (dut.mem_wdata[7:0] == 8'h0D) begin
+            end else if (uart_char == 8'h0D) begin
                 // Ignore carriage return
-            end else if (dut.mem_wdata[7:0] == 8'h04) begin
+            end else if (uart_char == 8'h05) begin
+                // ENQ: firmware asks the host to send UART_RX_MSG
+                -> uart_rx_request;
+            end else if (uart_char == 8'h16) begin
+                // SYN: firmware asks the host for an update image
+                -> update_request;
+            end else if (uart_char == 8'h04) begin
                 $display("\n[SIM] EOT received - Test Complete");
+                report_perf;
+                dump_trace;
                 #100;
                 $finish;
             end else begin
-                $write("[0x%02h]", dut.mem_wdata[7:0]);
+                $write("[0x%02h]", uart_char);
             end
             
             uart_char_count = uart_char_count + 1;
@@ -94,12 +166,166 @@ module tb_soc_top;
         end
     end
     
+    //=================================================================
+    // Performance Counters
+    //=================================================================
+    // Printed as "[PERF] key=value" lines before every $finish so that
+    // scripts/compare_isa.sh can build its report from the log.
+    //   boot_hmac_cycles : first crypto START to the last DONE before
+    //                      firmware entry (root HMAC)
+    //   fw_entry_cycle   : cycle of the first fetch from firmware IMEM
+    //   fw_cycles/fw_instret : measured from firmware entry (CPI), up to
+    //                      a warm reset if the firmware requests one
+    //   warm_boot_cycles : warm reset to the next firmware fetch
+    reg [63:0] cycle_count = 0;
+    reg [63:0] hmac_start_cycle = 0;
+    reg [63:0] hmac_done_cycle = 0;
+    reg        hmac_seen = 0;
+    reg        hmac_finished = 0;
+    reg [63:0] fw_entry_cycle = 0;
+    reg [63:0] fw_entry_instret = 0;
+    reg        fw_entered = 0;
+    reg        warm_seen = 0;
+    reg [63:0] warm_cycle = 0;
+    reg [63:0] warm_entry_cycle = 0;
+    reg        warm_entered = 0;
+    reg [63:0] fw_end_instret = 0;
+
+    always @(posedge clk) begin
+        if (rst_n) begin
+            cycle_count <= cycle_count + 1;
+
+            if (!hmac_seen && dut.crypto_inst.hmac_start) begin
+                hmac_seen <= 1;
+                hmac_start_cycle <= cycle_count;
+            end
+            if (hmac_seen && !fw_entered && dut.crypto_inst.hmac_done) begin
+                hmac_finished <= 1;
+                hmac_done_cycle <= cycle_count;
+            end
+
+            if (!fw_entered && dut.mem_valid && dut.mem_instr && dut.instr_mem_sel) begin
+                fw_entered <= 1;
+                fw_entry_cycle <= cycle_count;
+                fw_entry_instret <= dut.cpu.count_instr;
+            end
+
+            // The harts' counters restart on a warm reset
+            if (fw_entered && !warm_seen && dut.warm_rst) begin
+                warm_seen <= 1;
+                warm_cycle <= cycle_count;
+                fw_end_instret <= dut.cpu.count_instr;
+            end
+            if (warm_seen && !warm_entered && !dut.warm_rst &&
+                dut.mem_valid && dut.mem_instr && dut.instr_mem_sel) begin
+                warm_entered <= 1;
+                warm_entry_cycle <= cycle_count;
+            end
+        end
+    end
+
+    task report_perf;
+        reg [63:0] fw_cycles;
+        reg [63:0] fw_instret;
+        begin
+            fw_cycles  = !fw_entered ? 0 :
+                         warm_seen   ? warm_cycle - fw_entry_cycle :
+                                       cycle_count - fw_entry_cycle;
+            fw_instret = !fw_entered ? 0 :
+                         warm_seen   ? fw_end_instret - fw_entry_instret :
+                                       dut.cpu.count_instr - fw_entry_instret;
+            $display("[PERF] total_cycles=%0d", cycle_count);
+            $display("[PERF] boot_hmac_cycles=%0d",
+                     hmac_finished ? hmac_done_cycle - hmac_start_cycle : 0);
+            $display("[PERF] fw_entry_cycle=%0d", fw_entry_cycle);
+            $display("[PERF] fw_cycles=%0d", fw_cycles);
+            $display("[PERF] fw_instret=%0d", fw_instret);
+            $display("[PERF] warm_boot_cycles=%0d",
+                     warm_entered ? warm_entry_cycle - warm_cycle : 0);
+            if (fw_instret != 0)
+                $display("[PERF] fw_cpi=%0.3f", $itor(fw_cycles) / $itor(fw_instret));
+            else
+                $display("[PERF] fw_cpi=0");
+            report_boot_log;
+        end
+    endtask
+
+    //=================================================================
+    // Boot Log
+    //=================================================================
+    // Boot-latency report from the log the boot ROM writes at the start
+    // of data RAM (software/common/boot_log.h): one "[BOOT]" line per
+    // stage with its timestamp and the cycles spent in it. Shows the
+    // last boot (the warm one if the firmware warm-reset).
+    localparam BOOT_LOG_MAGIC  = 32'h474F4C42;
+    localparam BOOT_LOG_STAGES = 7;
+
+    task report_boot_log;
+        integer    n;
+        reg [31:0] cycle;
+        reg [31:0] prev;
+        begin
+            if (dut.data_mem_inst.mem[0] != BOOT_LOG_MAGIC) begin
+                $display("[BOOT] no boot log");
+            end else begin
+                prev = 0;
+                for (n = 0; n < BOOT_LOG_STAGES; n = n + 1) begin
+                    cycle = dut.data_mem_inst.mem[4 + 2*n];
+                    $display("[BOOT] %s cycle=%0d instret=%0d stage_cycles=%0d",
+                             n == 0 ? "start " : n == 1 ? "banner" : n == 2 ? "key   " :
+                             n == 3 ? "layout" : n == 4 ? "hash  " : n == 5 ? "verify" : "jump  ",
+                             cycle, dut.data_mem_inst.mem[5 + 2*n],
+                             (cycle == 0) ? 0 : cycle - prev);
+                    if (cycle != 0)
+                        prev = cycle;
+                end
+                $display("[BOOT] hmac_cycles=%0d hmac_bytes=%0d%s",
+                         dut.data_mem_inst.mem[2], dut.data_mem_inst.mem[3],
+                         dut.data_mem_inst.mem[1][0] ? " (cached)" : "");
+            end
+        end
+    endtask
+
+    //=================================================================
+    // Trace Dump
+    //=================================================================
+    // Writes the on-chip trace buffer (oldest entry first) to trace.txt
+    // as "INFO DATA" hex pairs for software/tools/trace_decode.py.
+    localparam TRACE_DEPTH = 256;   // soc_top trace_inst DEPTH
+
+    task dump_trace;
+        integer fd;
+        integer i;
+        integer n;
+        integer first;
+        begin
+            n     = dut.trace_inst.wrapped ? TRACE_DEPTH : dut.trace_inst.wr_ptr;
+            first = dut.trace_inst.wrapped ? dut.trace_inst.wr_ptr : 0;
+            fd = $fopen("trace.txt", "w");
+            $fdisplay(fd, "# trace_unit dump: %0d entries, %0d captured", n, dut.trace_inst.count);
+            for (i = 0; i < n; i = i + 1) begin
+                $fdisplay(fd, "%08h %08h",
+                          dut.trace_inst.buf_info[(first + i) % TRACE_DEPTH],
+                          dut.trace_inst.buf_data[(first + i) % TRACE_DEPTH]);
+            end
+            $fclose(fd);
+            $display("[TRACE] %0d entries written to trace.txt", n);
+        end
+    endtask
+
     //=================================================================
     // Trap Monitor
     //=================================================================
     always @(posedge trap) begin
         $display("\n[ERROR] *** TRAP occurred at PC=0x%08h ***", debug_pc);
         $display("         Instruction: 0x%08h", debug_insn);
+        if (dut.pv_inst.failed)
+            $display("         Firmware page %0d does not match its signed digest",
+                     dut.pv_inst.fail_page);
+        report_perf;
+        // Let the trace unit freeze, then dump it for post-mortem decode
+        @(posedge clk);
+        dump_trace;
         #100;
         $finish;
     end
@@ -150,6 +376,7 @@ module tb_soc_top;
             $display("⚠ Warning - No UART output detected");
         end
         
+        report_perf;
         $display("\nSimulation finished at %t", $time);
         $display("================================================\n");
         
@@ -164,6 +391,7 @@ module tb_soc_top;
         $display("\n[TIMEOUT] Simulation exceeded time limit!");
         $display("This might indicate the crypto accelerator is stuck.");
         $display("Check if HMAC calculation completed.");
+        report_perf;
         $finish;
     end
 
@@ -0,0 +1,92 @@
+#!/bin/bash
+#
+# ISA Comparison Script
+# Builds every test firmware for each -march setting, runs the
+# simulation and collects code size, boot HMAC cycles and firmware CPI
+# into a markdown report (reports/isa_report.md). build/ is wiped by
+# "make clean" between runs, so logs and the report live in reports/.
+#
+# Usage: ./scripts/compare_isa.sh [arch ...]
+#        (default: rv32i rv32im rv32imc)
+#
+
+set -e
+
+# Colors
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+BLUE='\033[0;34m'
+NC='\033[0m'
+
+PROJECT_ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD_DIR="$PROJECT_ROOT/build"
+REPORT_DIR="$PROJECT_ROOT/reports"
+REPORT="$REPORT_DIR/isa_report.md"
+TOOLCHAIN_PREFIX="${TOOLCHAIN_PREFIX:-riscv64-unknown-elf-}"
+
+ARCHS="${*:-rv32i rv32im rv32imc}"
+TESTS="test_anti_replay test_mpu test_secure_boot test_irq test_dma"
+
+mkdir -p "$REPORT_DIR"
+RESULTS="$REPORT_DIR/isa_results.tmp"
+: > "$RESULTS"
+
+echo -e "${BLUE}================================================${NC}"
+echo -e "${BLUE}  ISA Comparison: $ARCHS${NC}"
+echo -e "${BLUE}================================================${NC}\n"
+
+perf() {
+    # perf <log> <key>
+    grep -m1 "^\[PERF\] $2=" "$1" | sed "s/^\[PERF\] $2=//"
+}
+
+for arch in $ARCHS; do
+    for test in $TESTS; do
+        echo -e "${BLUE}[$arch] $test${NC}"
+        LOG="$REPORT_DIR/sim_${arch}_${test}.log"
+
+        cd "$PROJECT_ROOT/software"
+        make clean > /dev/null 2>&1
+        if ! make all ARCH="$arch" FW_TEST="$test" > "$REPORT_DIR/build_${arch}_${test}.log" 2>&1; then
+            echo -e "${RED}  ✗ Build failed (see $REPORT_DIR/build_${arch}_${test}.log)${NC}"
+            exit 1
+        fi
+
+        # .text+.rodata+.data of the firmware and the raw boot ROM size
+        FW_SIZE=$("${TOOLCHAIN_PREFIX}size" "$BUILD_DIR/firmware.elf" | awk 'NR==2 {print $1 + $2}')
+        BOOT_SIZE=$(stat -c %s "$BUILD_DIR/boot.bin")
+
+        cd "$PROJECT_ROOT"
+        ./scripts/simulate.sh > "$LOG" 2>&1 || true
+
+        HMAC=$(perf "$LOG" boot_hmac_cycles)
+        ENTRY=$(perf "$LOG" fw_entry_cycle)
+        INSTRET=$(perf "$LOG" fw_instret)
+        CPI=$(perf "$LOG" fw_cpi)
+
+        echo "$arch $test ${FW_SIZE:-?} ${BOOT_SIZE:-?} ${HMAC:-?} ${ENTRY:-?} ${INSTRET:-?} ${CPI:-?}" >> "$RESULTS"
+        echo -e "${GREEN}  ✓ size=${FW_SIZE}B hmac=${HMAC} entry=${ENTRY} cpi=${CPI}${NC}"
+    done
+done
+
+# Generate report
+{
+    echo "# ISA Comparison Report"
+    echo ""
+    echo "Generated by \`scripts/compare_isa.sh\` on $(date -u +%Y-%m-%d)."
+    echo ""
+    echo "| ISA | Firmware | FW size (B) | Boot ROM (B) | Boot HMAC (cycles) | FW entry (cycle) | FW instret | FW CPI |"
+    echo "|-----|----------|-------------|--------------|--------------------|------------------|------------|--------|"
+    while read -r arch test fw boot hmac entry instret cpi; do
+        echo "| $arch | $test | $fw | $boot | $hmac | $entry | $instret | $cpi |"
+    done < "$RESULTS"
+    echo ""
+    echo "- FW size: \`.text\` + \`.data\` of firmware.elf (what the boot ROM must hash)."
+    echo "- Boot HMAC: cycles from crypto START to DONE during secure boot."
+    echo "- FW CPI: cycles / retired instructions from firmware entry to end of test."
+} > "$REPORT"
+rm -f "$RESULTS"
+
+echo -e "\n${GREEN}✓ Report written to $REPORT${NC}\n"
+cat "$REPORT"
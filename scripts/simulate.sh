@@ -3,6 +3,9 @@
 # Simulation Script for Secure RISC-V SoC
 # Compiles Verilog and runs testbench with Icarus Verilog
 #
+# Environment:
+#   DUAL_CORE=1  Simulate the two-hart SoC variant (default: 0)
+#
 
 set -e  # Exit on error
 
@@ -17,6 +20,8 @@ echo -e "${BLUE}================================================${NC}"
 echo -e "${BLUE}  Secure RISC-V SoC - Simulation${NC}"
 echo -e "${BLUE}================================================${NC}\n"
 
+DUAL_CORE="${DUAL_CORE:-0}"
+
 # Project paths
 PROJECT_ROOT="$(cd "$(dirname "$0")/.." && pwd)"
 RTL_DIR="$PROJECT_ROOT/hardware/rtl"
@@ -29,7 +34,8 @@ mkdir -p "$BUILD_DIR"
 cd "$BUILD_DIR"
 
 echo -e "${GREEN}Project root: $PROJECT_ROOT${NC}"
-echo -e "${GREEN}Build directory: $BUILD_DIR${NC}\n"
+echo -e "${GREEN}Build directory: $BUILD_DIR${NC}"
+echo -e "${GREEN}Dual core: $DUAL_CORE${NC}\n"
 
 # Check for required files
 echo -e "${BLUE}[1/4] Checking memory initialization files...${NC}"
@@ -52,18 +58,27 @@ echo -e "${BLUE}[2/4] Compiling Verilog sources...${NC}"
 iverilog -g2012 \
     -o soc_sim.vvp \
     -s tb_soc_top \
+    -Ptb_soc_top.DUAL_CORE="$DUAL_CORE" \
     -I"$RTL_DIR" \
     "$TB_DIR/tb_soc_top.v" \
     "$RTL_DIR/top/soc_top.v" \
+    "$RTL_DIR/top/bus_arbiter.v" \
     "$RTL_DIR/cpu/picorv32.v" \
     "$RTL_DIR/memory/boot_rom.v" \
     "$RTL_DIR/memory/instruction_mem.v" \
     "$RTL_DIR/memory/data_mem.v" \
     "$RTL_DIR/peripherals/uart.v" \
+    "$RTL_DIR/peripherals/irq_ctrl.v" \
+    "$RTL_DIR/peripherals/timer.v" \
+    "$RTL_DIR/peripherals/hw_mutex.v" \
+    "$RTL_DIR/peripherals/dma.v" \
+    "$RTL_DIR/peripherals/trace_unit.v" \
     "$RTL_DIR/security/mpu.v" \
+    "$RTL_DIR/security/mpu_fault.v" \
     "$RTL_DIR/security/sha256.v" \
     "$RTL_DIR/security/hmac_sha256.v" \
     "$RTL_DIR/security/crypto_accelerator.v" \
+    "$RTL_DIR/security/page_verifier.v" \
     "$RTL_DIR/security/monotonic_counter.v" \
     "$RTL_DIR/security/nonce_gen.v" \
     "$RTL_DIR/security/anti_replay.v"
@@ -1,6 +1,8 @@
 #!/bin/bash
 #
 # Automated secure-boot regression covering friendly boot plus three tamper cases.
+# A payload bit-flip passes the boot ROM's root check and traps when the
+# page verifier checks the page on first access.
 # Usage:
 #   ./scripts/test_secure_boot_attacks.sh
 #
@@ -65,7 +67,7 @@ dst.write_bytes(data)
 print(f"Flipped byte 256 in {dst.name}")
 PY
 make_hex "$BITFLIP_BIN"
-run_sim "attack_bitflip_bad_sig"
+run_sim "attack_bitflip_page_trap"
 
 echo ""
 echo "[4/5] Attack #2: Corrupt firmware header magic"
@@ -75,8 +77,8 @@ import sys, struct, pathlib
 src = pathlib.Path(sys.argv[1])
 dst = pathlib.Path(sys.argv[2])
 data = bytearray(src.read_bytes())
-# Header starts at 0xFFC0 relative to firmware base.
-hdr_offset = 0xFFC0
+# Header offset is the image length word at +0x08.
+hdr_offset = int.from_bytes(data[8:12], "little")
 if len(data) < hdr_offset + 4:
     raise SystemExit("Firmware image missing header.")
 data[hdr_offset:hdr_offset+4] = (0xBAADF00D).to_bytes(4, "little")
@@ -94,7 +96,7 @@ import sys, pathlib
 src = pathlib.Path(sys.argv[1])
 dst = pathlib.Path(sys.argv[2])
 data = bytearray(src.read_bytes())
-hdr_offset = 0xFFC0
+hdr_offset = int.from_bytes(data[8:12], "little")
 sig_offset = hdr_offset + 0x20
 sig_len = 32
 if len(data) < sig_offset + sig_len:
@@ -0,0 +1,43 @@
+/*
+ * Boot Log
+ */
+
+#include "boot_log.h"
+#include "uart.h"
+
+static const char* const stage_names[BOOT_STAGE_COUNT] = {
+    "start ", "banner", "key   ", "layout", "hash  ", "verify", "jump  "
+};
+
+void boot_log_dump(void) {
+    volatile boot_log_t* log = BOOT_LOG;
+    uint32_t prev = 0;
+
+    if (log->magic != BOOT_LOG_MAGIC) {
+        uart_puts("Boot log: none\n");
+        return;
+    }
+
+    uart_puts("Boot log (cycles / instret at each stage, cycles in stage):\n");
+    for (int i = 0; i < BOOT_STAGE_COUNT; i++) {
+        uint32_t cycle = log->stage[i].cycle;
+
+        uart_puts("  ");
+        uart_puts(stage_names[i]);
+        uart_puts(" ");
+        uart_puthex(cycle);
+        uart_puts(" ");
+        uart_puthex(log->stage[i].instret);
+        uart_puts(" ");
+        uart_puthex(i == 0 ? cycle : cycle - prev);
+        uart_puts("\n");
+        prev = cycle;
+    }
+
+    uart_puts("  HMAC: ");
+    uart_puthex(log->hmac_cycles);
+    uart_puts(" cycles, ");
+    uart_puthex(log->hmac_bytes);
+    uart_puts(" bytes");
+    uart_puts((log->flags & BOOT_LOG_CACHED) ? " (cached, skipped)\n" : "\n");
+}
@@ -0,0 +1,48 @@
+/*
+ * Boot Log - Header
+ *
+ * The boot ROM (boot/boot_secure.S) timestamps each boot stage into
+ * this structure at the bottom of data RAM (reserved by firmware.ld).
+ * Timestamps are the low words of the cycle and instret counters,
+ * counted from reset; stage n-1 to stage n is the time spent in stage n.
+ * Stages the ROM did not reach (boot failed) are 0.
+ */
+
+#ifndef BOOT_LOG_H
+#define BOOT_LOG_H
+
+#include <stdint.h>
+
+#define BOOT_LOG_ADDR       0x10000000
+#define BOOT_LOG_MAGIC      0x474F4C42    // "BLOG"
+
+// flags
+#define BOOT_LOG_CACHED     (1 << 0)      // Warm reset, root HMAC skipped
+
+// Stages
+#define BOOT_STAGE_START    0             // Boot ROM entry (hart 0)
+#define BOOT_STAGE_BANNER   1             // Banner printed
+#define BOOT_STAGE_KEY      2             // Key loaded into the crypto core
+#define BOOT_STAGE_LAYOUT   3             // Header and page table located
+#define BOOT_STAGE_HASH     4             // Root HMAC done (or cached)
+#define BOOT_STAGE_VERIFY   5             // Signature compared, version floor checked
+#define BOOT_STAGE_JUMP     6             // Page verifier on, MPU locked
+#define BOOT_STAGE_COUNT    7
+
+typedef struct {
+    uint32_t magic;              // BOOT_LOG_MAGIC
+    uint32_t flags;              // BOOT_LOG_CACHED
+    uint32_t hmac_cycles;        // CRYPTO START to DONE seen
+    uint32_t hmac_bytes;         // Root HMAC message length
+    struct {
+        uint32_t cycle;
+        uint32_t instret;
+    } stage[BOOT_STAGE_COUNT];
+} boot_log_t;
+
+#define BOOT_LOG            ((volatile boot_log_t*)BOOT_LOG_ADDR)
+
+// Print the log of this boot as a per-stage table on the UART
+void boot_log_dump(void);
+
+#endif // BOOT_LOG_H
@@ -0,0 +1,43 @@
+/*
+ * DMA Controller API
+ */
+
+#include "soc_map.h"
+#include "dma.h"
+
+void dma_start_copy(void *dst, const void *src, unsigned int len, unsigned int flags) {
+    DMA_SRC = (unsigned int)src;
+    DMA_DST = (unsigned int)dst;
+    DMA_LEN = len;
+    DMA_CTRL = DMA_CTRL_START | flags;
+}
+
+void dma_start_fill(void *dst, unsigned int pattern, unsigned int len, unsigned int flags) {
+    DMA_DST = (unsigned int)dst;
+    DMA_LEN = len;
+    DMA_FILL = pattern;
+    DMA_CTRL = DMA_CTRL_START | DMA_CTRL_MODE_FILL | flags;
+}
+
+int dma_busy(void) {
+    return (DMA_STATUS & DMA_STATUS_BUSY) != 0;
+}
+
+int dma_wait(void) {
+    unsigned int status;
+
+    while ((status = DMA_STATUS) & DMA_STATUS_BUSY);
+    DMA_STATUS = DMA_STATUS_DONE | DMA_STATUS_ERROR;
+
+    return (status & DMA_STATUS_ERROR) ? -1 : 0;
+}
+
+int dma_copy(void *dst, const void *src, unsigned int len) {
+    dma_start_copy(dst, src, len, 0);
+    return dma_wait();
+}
+
+int dma_fill(void *dst, unsigned int pattern, unsigned int len) {
+    dma_start_fill(dst, pattern, len, 0);
+    return dma_wait();
+}
@@ -0,0 +1,26 @@
+/*
+ * DMA Controller API - Header
+ *
+ * Word-granular copy and fill through the DMA bus master. Addresses
+ * and lengths must be multiples of 4; anything else fails with
+ * DMA_STATUS_ERROR without touching memory.
+ */
+
+#ifndef DMA_H
+#define DMA_H
+
+// Start a transfer and return immediately (poll dma_busy() or enable
+// IRQ_SRC_DMA and pass DMA_CTRL_IRQ_EN in flags)
+void dma_start_copy(void *dst, const void *src, unsigned int len, unsigned int flags);
+void dma_start_fill(void *dst, unsigned int pattern, unsigned int len, unsigned int flags);
+
+int dma_busy(void);
+
+// Wait for the current transfer; returns 0 on success, -1 on error
+int dma_wait(void);
+
+// Blocking helpers
+int dma_copy(void *dst, const void *src, unsigned int len);
+int dma_fill(void *dst, unsigned int pattern, unsigned int len);
+
+#endif // DMA_H
@@ -1,8 +1,17 @@
 /*
  * Firmware Header Format
  * 
- * Defines the structure of signed firmware images.
- * The header is placed at a fixed offset from the start of firmware.
+ * Defines the structure of signed firmware images:
+ *
+ *   [image: length bytes][page table: page_count digests][header]
+ *
+ * The image is padded to FW_HEADER_ALIGN bytes and split into
+ * FW_PAGE_SIZE pages (the last may be short). The page table holds
+ * the SHA-256 of each page, padded to FW_HEADER_ALIGN bytes. The
+ * signature is the HMAC of the page table and the header up to the
+ * signature: a root over the page digests, so each page can be checked
+ * on its own once the root is verified. The word at FW_HEADER_OFF_OFFSET
+ * in the image holds the header offset.
  */
 
 #ifndef FIRMWARE_HEADER_H
@@ -15,11 +24,13 @@
 //=================================================================
 typedef struct {
     uint32_t magic;              // 0xDEADBEEF - identifies valid header
-    uint32_t version;            // Firmware version (for anti-rollback)
-    uint32_t length;             // Firmware length in bytes
+    uint32_t version;            // Firmware version (boot ROM checks VERSION_FLOOR)
+    uint32_t length;             // Image length in bytes = page table offset
     uint32_t entry_point;        // Entry point address (0x00010000)
     uint32_t timestamp;          // Build timestamp
-    uint32_t reserved[3];        // Reserved for future use
+    uint32_t page_size;          // FW_PAGE_SIZE
+    uint32_t page_count;         // Pages (and digests): ceil(length / page_size)
+    uint32_t reserved;           // Reserved for future use
     uint32_t signature[8];       // HMAC-SHA256 signature (256 bits = 8 x 32-bit words)
 } __attribute__((packed)) firmware_header_t;
 
@@ -27,17 +38,24 @@ typedef struct {
 // Constants
 //=================================================================
 #define FW_HEADER_MAGIC     0xDEADBEEF
-#define FW_HEADER_OFFSET    0xFFC0    // Place header at end of 64KB firmware space
+#define FW_HEADER_OFF_OFFSET 0x08     // Image word holding the header offset
+#define FW_HEADER_ALIGN     0x40      // Image length, table and header alignment
+#define FW_PAGE_SIZE        0x1000    // Bytes per page digest
+#define FW_HEADER_MAX       0xFFC0    // Last header offset in 64KB flash
                                        // 0x00010000 + 0xFFC0 = 0x0001FFC0
 
 //=================================================================
 // Helper Macros
 //=================================================================
 #define FIRMWARE_BASE       0x00010000
-#define FW_HEADER_ADDR      (FIRMWARE_BASE + FW_HEADER_OFFSET)
+#define FW_HEADER_OFF       (*(volatile uint32_t*)(FIRMWARE_BASE + FW_HEADER_OFF_OFFSET))
+#define FW_HEADER_ADDR      (FIRMWARE_BASE + FW_HEADER_OFF)
 
 // Get pointer to firmware header
 #define GET_FW_HEADER()     ((firmware_header_t*)FW_HEADER_ADDR)
 
+// Page digest table (8 words per page, in byte order like CRYPTO_HASH)
+#define GET_FW_PAGE_TABLE() ((const uint32_t (*)[8])(FIRMWARE_BASE + GET_FW_HEADER()->length))
+
 #endif // FIRMWARE_HEADER_H
 
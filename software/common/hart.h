@@ -0,0 +1,53 @@
+/*
+ * Multi-Hart Helpers
+ *
+ * Hart identification, secondary hart release and hardware mutexes
+ * for DUAL_CORE builds. In single-core builds hart_id() is always 0
+ * and the mutexes still work (they are simply never contended).
+ */
+
+#ifndef HART_H
+#define HART_H
+
+#include "soc_map.h"
+
+// Mutex assignments shared by all firmware
+#define MUTEX_UART          0
+#define MUTEX_CRYPTO        1
+#define MUTEX_ANTI_REPLAY   2
+
+static inline unsigned int hart_id(void) {
+    return HART_ID;
+}
+
+static inline unsigned int hart_count(void) {
+    return HART_NUM_HARTS;
+}
+
+// Let a parked hart leave the boot ROM; it enters secondary_main()
+static inline void hart_start(unsigned int hart) {
+    HART_RELEASE |= (1u << hart);
+}
+
+// Spin until the mutex is ours (each read is an acquire attempt)
+static inline void mutex_lock(unsigned int n) {
+    while (MUTEX_REG(n) == 0);
+}
+
+static inline int mutex_trylock(unsigned int n) {
+    return MUTEX_REG(n) != 0;
+}
+
+static inline void mutex_unlock(unsigned int n) {
+    MUTEX_REG(n) = 0;
+}
+
+// Cycle counter: rdcycle = csrrs rd, cycle (0xC00), x0. Emitted with
+// .insn (0xC00 as a signed 12-bit immediate) so Zicsr is not required
+static inline unsigned int rdcycle(void) {
+    unsigned int cycles;
+    __asm__ volatile (".insn i 0x73, 2, %0, x0, -1024" : "=r"(cycles));
+    return cycles;
+}
+
+#endif // HART_H
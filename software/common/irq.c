@@ -0,0 +1,90 @@
+/*
+ * Interrupt Dispatch
+ *
+ * The PicoRV32 IRQ instructions are emitted with .insn (custom-0,
+ * see custom_ops.S for the encodings) so the compiler can pick the
+ * registers.
+ */
+
+#include "soc_map.h"
+#include "irq.h"
+
+// CPU IRQ lines driven by the interrupt controller
+#define IRQ_EXT_MASK    (((1u << IRQ_NUM_SRC) - 1) << IRQ_EXT_BASE)
+
+static irq_handler_t irq_handlers[IRQ_NUM_SRC];
+static volatile unsigned int irq_spurious;
+
+unsigned int irq_set_mask(unsigned int mask) {
+    unsigned int old;
+    // maskirq old, mask
+    __asm__ volatile (".insn r 0x0B, 6, 3, %0, %1, x0" : "=r"(old) : "r"(mask) : "memory");
+    return old;
+}
+
+unsigned int irq_wait(void) {
+    unsigned int pending;
+    // waitirq pending
+    __asm__ volatile (".insn r 0x0B, 4, 4, %0, x0, x0" : "=r"(pending) : : "memory");
+    return pending;
+}
+
+void irq_init(void) {
+    IRQC_ENABLE = 0;
+    IRQC_PENDING = 0xFFFFFFFF;
+
+    // Unmask only the controller lines; EBREAK/illegal instruction and
+    // bus error stay masked so they still trap the CPU
+    irq_set_mask(~IRQ_EXT_MASK);
+}
+
+int irq_register(unsigned int src, irq_handler_t handler) {
+    if (src >= IRQ_NUM_SRC) {
+        return -1;
+    }
+    irq_handlers[src] = handler;
+    return 0;
+}
+
+void irq_enable(unsigned int src) {
+    if (src < IRQ_NUM_SRC) {
+        IRQC_ENABLE |= (1u << src);
+    }
+}
+
+void irq_disable(unsigned int src) {
+    if (src < IRQ_NUM_SRC) {
+        IRQC_ENABLE &= ~(1u << src);
+    }
+}
+
+unsigned int irq_spurious_count(void) {
+    return irq_spurious;
+}
+
+void irq_dispatch(unsigned int *regs, unsigned int irqs) {
+    unsigned int status;
+    (void)regs;
+    (void)irqs;
+
+    // The CPU only latches a pulse per new event; keep draining the
+    // controller so events arriving during a handler are not missed
+    while ((status = IRQC_STATUS) != 0) {
+        for (unsigned int src = 0; src < IRQ_NUM_SRC; src++) {
+            if (!(status & (1u << src))) {
+                continue;
+            }
+
+            // Acknowledge before the handler so a new edge re-pends
+            IRQC_PENDING = (1u << src);
+
+            if (irq_handlers[src]) {
+                irq_handlers[src](src);
+            } else {
+                // No handler: disable the source to avoid an IRQ storm
+                IRQC_ENABLE &= ~(1u << src);
+                irq_spurious++;
+            }
+        }
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * Interrupt Dispatch API - Header
+ *
+ * Peripheral interrupts go through the SoC interrupt controller
+ * (IRQC_* in soc_map.h) to PicoRV32 irq[IRQ_EXT_BASE + n]. The
+ * firmware IRQ entry in start.S calls irq_dispatch(), which runs the
+ * handler registered for every pending controller source.
+ */
+
+#ifndef IRQ_H
+#define IRQ_H
+
+typedef void (*irq_handler_t)(unsigned int src);
+
+// Clear the controller and unmask the external IRQ lines in the CPU
+void irq_init(void);
+
+// Install a handler for a controller source (IRQ_SRC_*)
+int irq_register(unsigned int src, irq_handler_t handler);
+
+// Enable / disable a controller source
+void irq_enable(unsigned int src);
+void irq_disable(unsigned int src);
+
+// Sleep until an IRQ is pending; returns the CPU pending bitmask
+unsigned int irq_wait(void);
+
+// Set the PicoRV32 IRQ mask (1 = masked); returns the previous mask
+unsigned int irq_set_mask(unsigned int mask);
+
+// Number of interrupts taken with no registered handler
+unsigned int irq_spurious_count(void);
+
+// Called from the IRQ entry in start.S
+void irq_dispatch(unsigned int *regs, unsigned int irqs);
+
+#endif // IRQ_H
@@ -20,12 +20,45 @@
 #define CRYPTO_BASE         0x30000000
 #define KEY_STORE_BASE      0x40000000    // Protected by MPU!
 #define ANTI_REPLAY_BASE    0x50000000    // Anti-replay protection
+#define SYSCTRL_BASE        0x60000000    // IRQ controller, timer
+#define DMA_BASE            0x70000000    // DMA controller (bus master)
+#define TRACE_BASE          0x80000000    // Instruction trace unit (hart 0)
+#define MPU_BASE            0x90000000    // MPU region configuration
 
 // UART Registers
 #define UART_TX_REG         (*(volatile unsigned int*)(UART_BASE + 0x00))
 #define UART_STATUS_REG     (*(volatile unsigned int*)(UART_BASE + 0x04))
+#define UART_TX_THRESH      (*(volatile unsigned int*)(UART_BASE + 0x08))
+#define UART_TX_FIFO_SIZE   (*(volatile unsigned int*)(UART_BASE + 0x0C))
+#define UART_RX_REG         (*(volatile unsigned int*)(UART_BASE + 0x10))
+#define UART_BAUD_DIV       (*(volatile unsigned int*)(UART_BASE + 0x14))
+#define UART_RX_THRESH      (*(volatile unsigned int*)(UART_BASE + 0x18))
+#define UART_RX_FIFO_SIZE   (*(volatile unsigned int*)(UART_BASE + 0x1C))
+#define UART_DMA_ADDR       (*(volatile unsigned int*)(UART_BASE + 0x20))
+#define UART_DMA_LEN        (*(volatile unsigned int*)(UART_BASE + 0x24))    // Write starts the job
+#define UART_DMA_CTRL       (*(volatile unsigned int*)(UART_BASE + 0x28))
+#define UART_DMA_STATUS     (*(volatile unsigned int*)(UART_BASE + 0x2C))
 
-#define UART_TX_BUSY        0x01
+#define UART_TX_BUSY        0x01        // Characters queued or being sent
+#define UART_TX_FULL        0x02        // TX FIFO full
+#define UART_TX_EMPTY       0x04        // All characters sent
+#define UART_TX_OVERRUN     0x08        // Character dropped (write 1 to clear)
+#define UART_RX_READY       0x10        // RX FIFO not empty
+#define UART_RX_FULL        0x20        // RX FIFO full
+#define UART_RX_OVERRUN     0x40        // Received character dropped (write 1 to clear)
+#define UART_RX_FRAME_ERR   0x80        // Missing stop bit (write 1 to clear)
+#define UART_RX_LEVEL(st)   (((st) >> 8) & 0x1F)
+#define UART_TX_LEVEL(st)   ((st) >> 16)
+#define UART_RX_VALID       0x100       // UART_RX_REG: bits 7:0 hold a character
+#define UART_BAUD_DIV_FOR(baud) (100000000u / (baud))   // 100 MHz clock, min 8
+
+#define UART_DMA_CTRL_IRQ_EN    0x01    // IRQ_SRC_UART_DMA while DONE is set
+#define UART_DMA_BUSY           0x01
+#define UART_DMA_DONE           0x02    // Write 1 to clear
+#define UART_DMA_ERROR          0x04    // MPU fault reading the buffer (write 1 to clear)
+// IRQ_SRC_UART is high while the TX level is below UART_TX_THRESH,
+// IRQ_SRC_UART_RX while the RX level is at or above UART_RX_THRESH
+// and IRQ_SRC_UART_DMA while a TX DMA job is done (with IRQ_EN)
 
 // Crypto Accelerator Registers
 #define CRYPTO_CTRL         (*(volatile unsigned int*)(CRYPTO_BASE + 0x00))
@@ -49,19 +82,37 @@
 #define CRYPTO_HASH_5       (*(volatile unsigned int*)(CRYPTO_BASE + 0x54))
 #define CRYPTO_HASH_6       (*(volatile unsigned int*)(CRYPTO_BASE + 0x58))
 #define CRYPTO_HASH_7       (*(volatile unsigned int*)(CRYPTO_BASE + 0x5C))
+#define CRYPTO_PKT_ADDR     (*(volatile unsigned int*)(CRYPTO_BASE + 0x60))
+#define CRYPTO_PKT_LEN      (*(volatile unsigned int*)(CRYPTO_BASE + 0x64))
+#define CRYPTO_PKT_TAG_OFF  (*(volatile unsigned int*)(CRYPTO_BASE + 0x68))
+#define CRYPTO_PKT_FIELDS   (*(volatile unsigned int*)(CRYPTO_BASE + 0x6C))
+#define CRYPTO_PKT_CONTEXT  (*(volatile unsigned int*)(CRYPTO_BASE + 0x70))
+#define CRYPTO_PKT_RESULT   (*(volatile unsigned int*)(CRYPTO_BASE + 0x74))
 
 // Crypto Control Bits
 #define CRYPTO_CTRL_START   (1 << 0)
 #define CRYPTO_CTRL_RESET   (1 << 1)
+#define CRYPTO_CTRL_CONTINUE (1 << 2)  // Append to the open streamed message
+#define CRYPTO_CTRL_MORE    (1 << 3)    // More chunks follow (MSG_LEN % 64 == 0)
 
 // Crypto Status Bits
 #define CRYPTO_STATUS_BUSY  (1 << 0)
 #define CRYPTO_STATUS_DONE  (1 << 1)
 #define CRYPTO_STATUS_ERROR (1 << 2)
+#define CRYPTO_STATUS_STREAM (1 << 3)  // Streamed message open
 
 // Crypto Modes
 #define CRYPTO_MODE_SHA256      0
 #define CRYPTO_MODE_HMAC_SHA256 1
+#define CRYPTO_MODE_PACKET      2   // HMAC tag check + anti-replay commit
+
+// Packet descriptor: counter / nonce offsets in CRYPTO_PKT_FIELDS
+#define CRYPTO_PKT_FIELDS_OF(ctr_off, nonce_off) \
+    (((unsigned int)(nonce_off) << 16) | ((ctr_off) & 0xFFFF))
+
+// CRYPTO_PKT_RESULT bits (bits 0-3 as REPLAY_STATUS)
+#define CRYPTO_PKT_BAD_TAG      (1 << 4)
+#define CRYPTO_PKT_BAD_DESC     (1 << 5)    // Incl. context >= REPLAY_NUM_CONTEXTS
 
 // Key Store Registers (PROTECTED - Machine mode only!)
 // Attempting to access these from user mode will cause MPU violation
@@ -80,6 +131,19 @@
 #define COUNTER_CTRL        (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x04))
 #define COUNTER_LOCK        (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x08))
 #define COUNTER_STATUS      (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x0C))
+#define COUNTER_INC_AND_READ (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x80))
+#define COUNTER_RESERVE     (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x84))
+#define COUNTER_RESERVE_N   (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x88))
+#define COUNTER_VALUE_HI    (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x8C))
+#define VERSION_FLOOR       (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x90))
+#define VERSION_CHECK       (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x94))
+#define VERSION_LOCK        (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x98))
+// INC_AND_READ / RESERVE: one load returns the (first) new sequence
+// number, 0 if the counter is locked or would overflow. The counter is
+// 64 bits; COUNTER_VALUE_HI holds bits 63:32 of the last value read.
+// VERSION_FLOOR: lowest bootable firmware version (anti-rollback). The
+// boot ROM writes the header version to VERSION_CHECK (checked and, if
+// not lower, made the new floor) and locks it with COUNTER_LOCK_MAGIC.
 
 // Nonce Generator (0x50000010 - 0x5000001F)
 #define NONCE_VALUE         (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x10))
@@ -87,7 +151,7 @@
 #define NONCE_CTRL          (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x18))
 #define NONCE_STATUS        (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x1C))
 
-// Anti-Replay Engine (0x50000020 - 0x5000003F)
+// Anti-Replay Engine (0x50000020 - 0x5000007F)
 #define REPLAY_LAST_COUNTER (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x20))
 #define REPLAY_CHECK_COUNTER (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x24))
 #define REPLAY_CHECK_NONCE  (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x28))
@@ -95,6 +159,26 @@
 #define REPLAY_STATUS       (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x30))
 #define REPLAY_CACHE_SIZE   (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x34))
 #define REPLAY_CTRL         (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x38))
+#define REPLAY_CACHE_CAPACITY (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x3C))
+#define REPLAY_WINDOW_SIZE  (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x40))
+#define REPLAY_CONTEXT_ID   (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x44))
+#define REPLAY_NUM_CONTEXTS (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x48))
+#define REPLAY_REQ_PUSH     (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x4C))
+#define REPLAY_RESULT_POP   (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x50))
+#define REPLAY_BATCH_STATUS (*(volatile unsigned int*)(ANTI_REPLAY_BASE + 0x54))
+
+// Batch requests: write context, counter, nonce to REPLAY_REQ_PUSH
+#define REPLAY_BATCH_DEPTH          32
+#define REPLAY_BATCH_REQS(st)       ((st) & 0xFF)
+#define REPLAY_BATCH_RESULTS(st)    (((st) >> 8) & 0xFF)
+#define REPLAY_BATCH_BUSY           (1 << 16)
+#define REPLAY_BATCH_OVERFLOW       (1 << 17)   // REQ_PUSH dropped; write 1 to clear
+// A full result FIFO pauses the batch until RESULT_POP makes room
+
+// REPLAY_RESULT_POP word: status bits 0-3 as REPLAY_STATUS
+#define REPLAY_RESULT_PRESENT       (1 << 8)
+#define REPLAY_RESULT_BAD_CONTEXT   (1 << 9)    // Context >= REPLAY_NUM_CONTEXTS, not checked
+#define REPLAY_RESULT_CONTEXT(r)    (((r) >> 16) & 0xFF)
 
 // Counter Control Bits
 #define COUNTER_CTRL_INCREMENT  (1 << 0)
@@ -104,13 +188,22 @@
 // Counter Status Bits
 #define COUNTER_STATUS_LOCKED   (1 << 0)
 #define COUNTER_STATUS_OVERFLOW (1 << 1)
+#define COUNTER_STATUS_VERSION_LOCKED (1 << 2)
+#define VERSION_CHECK_OK        (1 << 0)
 
 // Nonce Control Bits
-#define NONCE_CTRL_ENABLE       (1 << 0)
-#define NONCE_CTRL_ADVANCE      (1 << 1)
+#define NONCE_CTRL_ENABLE       (1 << 0)    // Refill the nonce FIFO
+#define NONCE_CTRL_ADVANCE      (1 << 1)    // Drop the oldest word
+#define NONCE_CTRL_READ_ADVANCE (1 << 2)    // Every NONCE_VALUE read is fresh
+// Reset: ENABLE | READ_ADVANCE; a 64/128-bit nonce is 2/4 reads.
+// NONCE_CTRL = NONCE_CTRL_ADVANCE only drops a word: a write with
+// ADVANCE set keeps ENABLE and READ_ADVANCE, any other write sets them
 
 // Nonce Status Bits
 #define NONCE_STATUS_READY      (1 << 0)
+#define NONCE_STATUS_LEVEL(st)  (((st) >> 8) & 0x3F)
+#define NONCE_STATUS_UNDERFLOW  (1 << 16)   // Write 1 to clear
+#define NONCE_FIFO_DEPTH        32
 
 // Replay Status Bits
 #define REPLAY_STATUS_VALID        (1 << 0)
@@ -122,6 +215,179 @@
 // Replay Control Bits
 #define REPLAY_CTRL_RESET_CACHE (1 << 0)
 #define REPLAY_CTRL_RESET_STATE (1 << 1)
+#define REPLAY_CTRL_WINDOW      (1 << 2)    // Sliding window counter check
+#define REPLAY_CTRL_NONCE_OFF   (1 << 3)    // Skip the nonce store
+#define REPLAY_CTRL_RESET_CONTEXT (1 << 4)  // Reset REPLAY_CONTEXT_ID only
+#define REPLAY_CTRL_FLUSH       (1 << 5)    // Empty the batch FIFOs
+// Every REPLAY_CTRL write also sets the WINDOW / NONCE_OFF mode bits
+
+// System Control: Interrupt Controller (0x60000000 - 0x6000001F)
+#define IRQC_PENDING        (*(volatile unsigned int*)(SYSCTRL_BASE + 0x00))
+#define IRQC_ENABLE         (*(volatile unsigned int*)(SYSCTRL_BASE + 0x04))
+#define IRQC_STATUS         (*(volatile unsigned int*)(SYSCTRL_BASE + 0x08))
+#define IRQC_RAW            (*(volatile unsigned int*)(SYSCTRL_BASE + 0x0C))
+#define IRQC_FORCE          (*(volatile unsigned int*)(SYSCTRL_BASE + 0x10))
+
+// Interrupt sources (bit index in IRQC registers)
+#define IRQ_SRC_TIMER       0
+#define IRQ_SRC_UART        1
+#define IRQ_SRC_CRYPTO      2
+#define IRQ_SRC_ANTI_REPLAY 3
+#define IRQ_SRC_DMA         4
+#define IRQ_SRC_MPU_FAULT   5
+#define IRQ_SRC_UART_RX     6
+#define IRQ_SRC_UART_DMA    7
+#define IRQ_NUM_SRC         8
+
+// Source n is wired to PicoRV32 irq[IRQ_EXT_BASE + n]
+#define IRQ_EXT_BASE        3
+
+// System Control: Timer (0x60000020 - 0x6000003F)
+#define TIMER_COUNT         (*(volatile unsigned int*)(SYSCTRL_BASE + 0x20))
+#define TIMER_COMPARE       (*(volatile unsigned int*)(SYSCTRL_BASE + 0x24))
+#define TIMER_CTRL          (*(volatile unsigned int*)(SYSCTRL_BASE + 0x28))
+#define TIMER_STATUS        (*(volatile unsigned int*)(SYSCTRL_BASE + 0x2C))
+#define TIMER_PRESCALE      (*(volatile unsigned int*)(SYSCTRL_BASE + 0x30))
+
+// Timer Control Bits
+#define TIMER_CTRL_ENABLE       (1 << 0)
+#define TIMER_CTRL_AUTO_RELOAD  (1 << 1)
+#define TIMER_CTRL_IRQ_EN       (1 << 2)
+
+// Timer Status Bits
+#define TIMER_STATUS_MATCH      (1 << 0)
+
+// System Control: Hart ID / Hardware Mutex (0x60000040 - 0x6000007F)
+#define HART_ID             (*(volatile unsigned int*)(SYSCTRL_BASE + 0x40))
+#define HART_NUM_HARTS      (*(volatile unsigned int*)(SYSCTRL_BASE + 0x44))
+#define HART_RELEASE        (*(volatile unsigned int*)(SYSCTRL_BASE + 0x48))
+#define MUTEX_LOCKED        (*(volatile unsigned int*)(SYSCTRL_BASE + 0x4C))
+#define MUTEX_REG(n)        (*(volatile unsigned int*)(SYSCTRL_BASE + 0x60 + ((n) << 2)))
+#define MUTEX_COUNT         8
+
+#define HART_STACK_SIZE     0x4000        // Per-hart stack (see start.S)
+
+// System Control: Boot Status (0x60000080 - 0x600000BF)
+// Kept across warm resets; IMEM_DIGEST/BOOT_STATUS writes are boot ROM only
+#define IMEM_DIGEST(n)      (*(volatile unsigned int*)(SYSCTRL_BASE + 0x80 + ((n) << 2)))
+#define BOOT_STATUS         (*(volatile unsigned int*)(SYSCTRL_BASE + 0xA0))
+#define BOOT_RESET          (*(volatile unsigned int*)(SYSCTRL_BASE + 0xA4))
+
+// BOOT_STATUS Bits
+#define BOOT_STATUS_IMEM_DIRTY  (1 << 0)    // IMEM written since last verified
+#define BOOT_STATUS_WARM        (1 << 1)    // A warm reset has occurred
+
+// Write to BOOT_RESET: reset everything but IMEM and its verification state
+#define BOOT_WARM_RESET_KEY     0xB007C0DE
+
+// DMA Controller (0x70000000 - 0x700000FF)
+#define DMA_SRC             (*(volatile unsigned int*)(DMA_BASE + 0x00))
+#define DMA_DST             (*(volatile unsigned int*)(DMA_BASE + 0x04))
+#define DMA_LEN             (*(volatile unsigned int*)(DMA_BASE + 0x08))
+#define DMA_CTRL            (*(volatile unsigned int*)(DMA_BASE + 0x0C))
+#define DMA_STATUS          (*(volatile unsigned int*)(DMA_BASE + 0x10))
+#define DMA_FILL            (*(volatile unsigned int*)(DMA_BASE + 0x14))
+#define DMA_REMAINING       (*(volatile unsigned int*)(DMA_BASE + 0x18))
+
+// DMA Control Bits
+#define DMA_CTRL_START      (1 << 0)
+#define DMA_CTRL_MODE_FILL  (1 << 1)
+#define DMA_CTRL_IRQ_EN     (1 << 2)
+#define DMA_CTRL_SRC_FIXED  (1 << 3)
+#define DMA_CTRL_DST_FIXED  (1 << 4)
+
+// DMA Status Bits
+#define DMA_STATUS_BUSY     (1 << 0)
+#define DMA_STATUS_DONE     (1 << 1)
+#define DMA_STATUS_ERROR    (1 << 2)
+
+// Instruction Trace Unit (0x80000000 - 0x800000FF)
+#define TRACE_CTRL          (*(volatile unsigned int*)(TRACE_BASE + 0x00))
+#define TRACE_STATUS        (*(volatile unsigned int*)(TRACE_BASE + 0x04))
+#define TRACE_TRIG_ADDR     (*(volatile unsigned int*)(TRACE_BASE + 0x08))
+#define TRACE_STOP_ADDR     (*(volatile unsigned int*)(TRACE_BASE + 0x0C))
+#define TRACE_WR_PTR        (*(volatile unsigned int*)(TRACE_BASE + 0x10))
+#define TRACE_COUNT         (*(volatile unsigned int*)(TRACE_BASE + 0x14))
+#define TRACE_RD_IDX        (*(volatile unsigned int*)(TRACE_BASE + 0x18))
+#define TRACE_RD_DATA       (*(volatile unsigned int*)(TRACE_BASE + 0x1C))
+#define TRACE_RD_INFO       (*(volatile unsigned int*)(TRACE_BASE + 0x20))
+#define TRACE_DEPTH         (*(volatile unsigned int*)(TRACE_BASE + 0x24))
+
+// Trace Control Bits
+#define TRACE_CTRL_ENABLE       (1 << 0)
+#define TRACE_CTRL_CAP_BRANCH   (1 << 1)
+#define TRACE_CTRL_CAP_ADDR     (1 << 2)
+#define TRACE_CTRL_CAP_DATA     (1 << 3)
+#define TRACE_CTRL_STOP_ON_TRAP (1 << 4)
+#define TRACE_CTRL_TRIG_EN      (1 << 5)
+#define TRACE_CTRL_STOP_EN      (1 << 6)
+#define TRACE_CTRL_CLEAR        (1 << 7)
+
+// Trace Status Bits
+#define TRACE_STATUS_RUNNING    (1 << 0)
+#define TRACE_STATUS_TRIGGERED  (1 << 1)
+#define TRACE_STATUS_STOPPED    (1 << 2)
+#define TRACE_STATUS_WRAPPED    (1 << 3)
+
+// Trace entry INFO fields
+#define TRACE_INFO_BRANCH       (1 << 0)
+#define TRACE_INFO_ADDR         (1 << 1)
+#define TRACE_INFO_IRQ          (1 << 3)
+#define TRACE_INFO_DELTA(info)  ((info) >> 4)
+
+// MPU Region Configuration (0x90000000 - 0x900001FF)
+#define MPU_NUM_REGIONS     (*(volatile unsigned int*)(MPU_BASE + 0x000))
+#define MPU_LOCK            (*(volatile unsigned int*)(MPU_BASE + 0x004))
+#define MPU_REGION_BASE(n)  (*(volatile unsigned int*)(MPU_BASE + 0x100 + ((n) << 4)))
+#define MPU_REGION_MASK(n)  (*(volatile unsigned int*)(MPU_BASE + 0x104 + ((n) << 4)))
+#define MPU_REGION_ATTR(n)  (*(volatile unsigned int*)(MPU_BASE + 0x108 + ((n) << 4)))
+
+// MPU Region Attribute Bits
+#define MPU_ATTR_R          (1 << 0)
+#define MPU_ATTR_W          (1 << 1)
+#define MPU_ATTR_X          (1 << 2)
+#define MPU_ATTR_PRIV       (1 << 3)    // Boot ROM (machine mode) only
+#define MPU_ATTR_ENABLE     (1 << 4)
+#define MPU_ATTR_LOCK       (1 << 7)    // Read-only, set through MPU_LOCK
+
+// Regions set up at reset and locked by the boot ROM
+#define MPU_REGION_KEY_STORE    5
+#define MPU_BOOT_REGIONS        11
+
+// MPU Fault Capture (0x90000040 - 0x9000005F)
+// Violating accesses are always blocked (writes dropped, reads return 0)
+#define MPU_FAULT_ADDR      (*(volatile unsigned int*)(MPU_BASE + 0x040))
+#define MPU_FAULT_INFO      (*(volatile unsigned int*)(MPU_BASE + 0x044))
+#define MPU_FAULT_PC        (*(volatile unsigned int*)(MPU_BASE + 0x048))
+#define MPU_FAULT_COUNT     (*(volatile unsigned int*)(MPU_BASE + 0x04C))
+#define MPU_FAULT_CTRL      (*(volatile unsigned int*)(MPU_BASE + 0x050))
+
+// MPU_FAULT_INFO Bits
+#define MPU_FAULT_VALID         (1 << 0)    // Write 1 to clear
+#define MPU_FAULT_OVERRUN       (1 << 1)    // Fault while VALID was set
+#define MPU_FAULT_READ          (1 << 2)
+#define MPU_FAULT_WRITE         (1 << 3)
+#define MPU_FAULT_EXEC          (1 << 4)
+#define MPU_FAULT_PRIV          (1 << 5)
+#define MPU_FAULT_MASTER(info)  (((info) >> 8) & 0x7)
+
+// MPU_FAULT_CTRL Bits (reset: TRAP_EN)
+#define MPU_FAULT_CTRL_TRAP_EN  (1 << 0)    // CPU violations halt the SoC
+#define MPU_FAULT_CTRL_IRQ_EN   (1 << 1)    // IRQ_SRC_MPU_FAULT while VALID
+
+// Firmware Page Verifier (0x90000060 - 0x9000007F)
+// Enabled by the boot ROM: firmware pages are hashed on first access
+#define PV_CTRL             (*(volatile unsigned int*)(MPU_BASE + 0x060))
+#define PV_TABLE            (*(volatile unsigned int*)(MPU_BASE + 0x064))
+#define PV_LENGTH           (*(volatile unsigned int*)(MPU_BASE + 0x068))
+#define PV_VERIFIED         (*(volatile unsigned int*)(MPU_BASE + 0x06C))
+#define PV_STATUS           (*(volatile unsigned int*)(MPU_BASE + 0x070))
+
+// PV_CTRL / PV_STATUS Bits
+#define PV_CTRL_ENABLE          (1 << 0)    // Set once, cleared by reset
+#define PV_STATUS_BUSY          (1 << 0)
+#define PV_STATUS_FAIL          (1 << 1)    // Page mismatch (SoC trapped)
+#define PV_FAIL_PAGE(status)    (((status) >> 8) & 0xF)
 
 #endif // SOC_MAP_H
 
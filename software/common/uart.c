@@ -5,13 +5,36 @@
 #include "soc_map.h"
 
 void uart_putc(char c) {
-    // Wait if TX is busy
-    while (UART_STATUS_REG & UART_TX_BUSY);
+    // Wait only if the TX FIFO is full
+    while (UART_STATUS_REG & UART_TX_FULL);
     
-    // Send character
+    // Queue character
     UART_TX_REG = c;
 }
 
+void uart_flush(void) {
+    // Wait until every queued character has been sent
+    while (UART_STATUS_REG & UART_TX_BUSY);
+}
+
+void uart_dma_wait(void) {
+    while (UART_DMA_STATUS & UART_DMA_BUSY);
+}
+
+void uart_write_dma(const void* buf, unsigned int len) {
+    // The UART reads the buffer itself; it must stay unchanged until
+    // the job is done (uart_dma_wait or IRQ_SRC_UART_DMA)
+    uart_dma_wait();
+    UART_DMA_ADDR = (unsigned int)buf;
+    UART_DMA_LEN = len;
+}
+
+int uart_getc(void) {
+    // Pop one received character, -1 if none is waiting
+    unsigned int rx = UART_RX_REG;
+    return (rx & UART_RX_VALID) ? (int)(rx & 0xFF) : -1;
+}
+
 void uart_puts(const char* s) {
     while (*s) {
         if (*s == '\n') {
@@ -8,6 +8,12 @@
 void uart_putc(char c);
 void uart_puts(const char* s);
 void uart_puthex(unsigned int val);
+void uart_flush(void);
+int  uart_getc(void);
+
+// TX DMA: queue len bytes from buf without the CPU (sent as-is, no CRLF)
+void uart_write_dma(const void* buf, unsigned int len);
+void uart_dma_wait(void);
 
 #endif // UART_H
 
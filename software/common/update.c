@@ -0,0 +1,223 @@
+/*
+ * Firmware Update Agent
+ */
+
+#include "update.h"
+#include "firmware_header.h"
+#include "hart.h"
+#include "soc_map.h"
+#include "uart.h"
+
+#define UPDATE_BLOCK        64            // Streamed SHA-256 chunk
+#define UPDATE_MAX_PAGES    16
+#define UPDATE_RX_TIMEOUT   1000000       // Polls without a character
+
+static volatile uint8_t* const staging = (volatile uint8_t*)UPDATE_STAGING;
+static uint32_t page_digest[UPDATE_MAX_PAGES][8];
+
+static int rx_byte(void) {
+    for (uint32_t n = 0; n < UPDATE_RX_TIMEOUT; n++) {
+        int c = uart_getc();
+        if (c >= 0) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+// Wait for the last crypto operation; 0 on success
+static int crypto_wait(void) {
+    unsigned int status;
+
+    while (!((status = CRYPTO_STATUS) & CRYPTO_STATUS_DONE));
+    return (status & CRYPTO_STATUS_ERROR) ? -1 : 0;
+}
+
+// Image length L from the header offset H: the page table of
+// N = ceil(L / 4K) digests, padded to 64 bytes, sits between them.
+// At most one N fits; 0 if none does.
+static uint32_t image_length(uint32_t hdr_off) {
+    for (uint32_t n = 1; n <= UPDATE_MAX_PAGES; n++) {
+        uint32_t table = (n * 32 + FW_HEADER_ALIGN - 1) & ~(FW_HEADER_ALIGN - 1);
+        if (hdr_off <= table) {
+            break;
+        }
+        uint32_t len = hdr_off - table;
+        if ((len + FW_PAGE_SIZE - 1) / FW_PAGE_SIZE == n) {
+            return len;
+        }
+    }
+    return 0;
+}
+
+int update_receive(update_stats_t* stats) {
+    uint32_t total = 0;
+    uint32_t img_len = 0;
+    int pending = -1;                     // Page whose last block is hashing
+    int issued = 0;
+    uint32_t start = 0;
+
+    stats->length = 0;
+    stats->rx_cycles = 0;
+    stats->verify_cycles = 0;
+
+    // Touch every page of the running image first: the page verifier
+    // would otherwise stall this loop for a page hash mid-transfer,
+    // longer than the 16-character RX FIFO lasts
+    const firmware_header_t* running = GET_FW_HEADER();
+    for (uint32_t p = 0; p < running->page_count; p++) {
+        (void)*(volatile uint32_t*)(FIRMWARE_BASE + p * FW_PAGE_SIZE);
+    }
+
+    while (uart_getc() >= 0);
+    UART_STATUS_REG = UART_RX_OVERRUN | UART_RX_FRAME_ERR;
+    uart_putc(UPDATE_REQUEST);
+
+    for (int i = 0; i < 4; i++) {
+        int c = rx_byte();
+        if (c < 0) {
+            return UPDATE_ERR_RX;
+        }
+        total |= (uint32_t)c << (i * 8);
+    }
+    if (total == 0 || total > UPDATE_STAGING_SIZE || (total % FW_HEADER_ALIGN) != 0) {
+        return UPDATE_ERR_LENGTH;
+    }
+
+    // Receive, hashing each page block by block as it completes
+    for (uint32_t n = 0; n < total; n++) {
+        int c = rx_byte();
+        if (c < 0) {
+            return UPDATE_ERR_RX;
+        }
+        if (n == 0) {
+            start = rdcycle();
+        }
+        staging[n] = (uint8_t)c;
+
+        if ((n + 1) % UPDATE_BLOCK != 0) {
+            continue;
+        }
+        uint32_t off = n + 1 - UPDATE_BLOCK;
+
+        if (off == 0) {
+            // Block 0 holds the header offset: fixes the page layout
+            uint32_t hdr_off = *(volatile uint32_t*)(UPDATE_STAGING + FW_HEADER_OFF_OFFSET);
+            if (hdr_off + sizeof(firmware_header_t) != total) {
+                return UPDATE_ERR_LENGTH;
+            }
+            img_len = image_length(hdr_off);
+            if (img_len == 0) {
+                return UPDATE_ERR_LENGTH;
+            }
+        }
+        if (off >= img_len) {
+            continue;                     // Page table and header
+        }
+
+        if (issued && crypto_wait() != 0) {
+            return UPDATE_ERR_PAGE;
+        }
+        if (pending >= 0) {
+            for (int i = 0; i < 8; i++) {
+                page_digest[pending][i] = (&CRYPTO_HASH_0)[i];
+            }
+            pending = -1;
+        }
+
+        // One streamed chunk per block: a page starts a new message,
+        // its last block ends it
+        uint32_t page = off / FW_PAGE_SIZE;
+        uint32_t page_end = (page + 1) * FW_PAGE_SIZE;
+        if (page_end > img_len) {
+            page_end = img_len;
+        }
+        uint32_t ctrl = CRYPTO_CTRL_START;
+        if (off % FW_PAGE_SIZE != 0) {
+            ctrl |= CRYPTO_CTRL_CONTINUE;
+        }
+        if (off + UPDATE_BLOCK < page_end) {
+            ctrl |= CRYPTO_CTRL_MORE;
+        } else {
+            pending = page;
+        }
+        CRYPTO_MSG_ADDR = UPDATE_STAGING + off;
+        CRYPTO_MSG_LEN = UPDATE_BLOCK;
+        CRYPTO_MODE = CRYPTO_MODE_SHA256;
+        CRYPTO_CTRL = ctrl;
+        issued = 1;
+    }
+
+    uint32_t last = rdcycle();
+    stats->length = total;
+    stats->rx_cycles = last - start;
+
+    if (UART_STATUS_REG & (UART_RX_OVERRUN | UART_RX_FRAME_ERR)) {
+        return UPDATE_ERR_RX;
+    }
+
+    // Last page digest: the final block always ends the last page,
+    // which is usually partial (img_len is only 64-byte aligned)
+    if (crypto_wait() != 0) {
+        return UPDATE_ERR_PAGE;
+    }
+    for (int i = 0; i < 8; i++) {
+        page_digest[pending][i] = (&CRYPTO_HASH_0)[i];
+    }
+
+    int ret = UPDATE_OK;
+    uint32_t hdr_off = total - sizeof(firmware_header_t);
+    const firmware_header_t* hdr = (const firmware_header_t*)(UPDATE_STAGING + hdr_off);
+    const uint32_t (*table)[8] = (const uint32_t (*)[8])(UPDATE_STAGING + img_len);
+    uint32_t pages = (img_len + FW_PAGE_SIZE - 1) / FW_PAGE_SIZE;
+
+    if (hdr->magic != FW_HEADER_MAGIC || hdr->length != img_len ||
+        hdr->page_size != FW_PAGE_SIZE || hdr->page_count != pages) {
+        ret = UPDATE_ERR_HEADER;
+    }
+
+    for (uint32_t p = 0; ret == UPDATE_OK && p < pages; p++) {
+        for (int i = 0; i < 8; i++) {
+            if (page_digest[p][i] != table[p][i]) {
+                ret = UPDATE_ERR_PAGE;
+            }
+        }
+    }
+
+    // Root: HMAC of the table and the header up to the signature, as
+    // the boot ROM checks it
+    if (ret == UPDATE_OK) {
+        CRYPTO_MSG_ADDR = UPDATE_STAGING + img_len;
+        CRYPTO_MSG_LEN = hdr_off - img_len + 0x20;
+        CRYPTO_MODE = CRYPTO_MODE_HMAC_SHA256;
+        CRYPTO_CTRL = CRYPTO_CTRL_START;
+        if (crypto_wait() != 0) {
+            ret = UPDATE_ERR_SIG;
+        }
+        for (int i = 0; ret == UPDATE_OK && i < 8; i++) {
+            if ((&CRYPTO_HASH_0)[i] != hdr->signature[i]) {
+                ret = UPDATE_ERR_SIG;
+            }
+        }
+    }
+
+    // The boot ROM would refuse it: below the floor it raised to the
+    // running version
+    if (ret == UPDATE_OK && hdr->version < VERSION_FLOOR) {
+        ret = UPDATE_ERR_ROLLBACK;
+    }
+
+    stats->verify_cycles = rdcycle() - last;
+    return ret;
+}
+
+void update_commit(void) {
+    UPDATE_RECORD->length = *(volatile uint32_t*)(UPDATE_STAGING + FW_HEADER_OFF_OFFSET) +
+                            sizeof(firmware_header_t);
+    UPDATE_RECORD->magic = UPDATE_MAGIC;
+
+    uart_flush();
+    BOOT_RESET = BOOT_WARM_RESET_KEY;
+    while (1) {
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * Firmware Update Agent - Header
+ *
+ * Receives a signed image (firmware_header.h layout, through the header)
+ * over the UART into a staging area in data RAM and verifies it while
+ * it arrives: each 64-byte block is fed to the crypto accelerator as a
+ * streamed SHA-256 chunk as soon as it lands, so the page digests are
+ * ready with the last image byte. Only the table HMAC and compares are
+ * left after the transfer.
+ *
+ * Protocol (host side in hardware/tb/tb_soc_top.v):
+ *   device: UPDATE_REQUEST (SYN)
+ *   host:   total length T (32-bit little-endian), then T image bytes
+ *
+ * A verified image is committed by update_commit(): it leaves a record
+ * below the boot log area and warm-resets. The boot ROM verifies the
+ * staged image in place and only then copies it into instruction
+ * memory, verifying the copy like any other boot; a bad record or
+ * staging area is dropped and the current firmware boots, and a reset
+ * during the copy just repeats it.
+ */
+
+#ifndef UPDATE_H
+#define UPDATE_H
+
+#include <stdint.h>
+
+#define UPDATE_REQUEST      0x16          // SYN: host starts sending
+#define UPDATE_STAGING      0x10002000    // Staging area (reserved by firmware.ld)
+#define UPDATE_STAGING_SIZE 0x6000        // Largest image + table + header
+
+// Commit record, read and cleared by the boot ROM after the warm reset
+#define UPDATE_RECORD_ADDR  0x10000048    // Right after the boot log
+#define UPDATE_MAGIC        0x54445055    // "UPDT"
+
+typedef struct {
+    uint32_t magic;              // UPDATE_MAGIC: copy the staged image
+    uint32_t length;             // Bytes at UPDATE_STAGING (image through header)
+} update_record_t;
+
+#define UPDATE_RECORD       ((volatile update_record_t*)UPDATE_RECORD_ADDR)
+
+// update_receive() results
+#define UPDATE_OK           0
+#define UPDATE_ERR_LENGTH   -1            // Bad total length or layout
+#define UPDATE_ERR_RX       -2            // UART timeout or overrun
+#define UPDATE_ERR_HEADER   -3            // Bad magic or header fields
+#define UPDATE_ERR_PAGE     -4            // Page does not match the table
+#define UPDATE_ERR_SIG      -5            // Table HMAC does not match
+#define UPDATE_ERR_ROLLBACK -6            // Below VERSION_FLOOR
+
+typedef struct {
+    uint32_t length;             // Bytes received
+    uint32_t rx_cycles;          // First to last byte
+    uint32_t verify_cycles;      // Last byte to verdict
+} update_stats_t;
+
+// Request an image from the host, receive and verify it. The key must
+// still be in the crypto accelerator (loaded by the boot ROM).
+int update_receive(update_stats_t* stats);
+
+// Install the verified staged image through the boot ROM (does not return)
+void update_commit(void);
+
+#endif // UPDATE_H
@@ -6,11 +6,45 @@
 
 #include "soc_map.h"
 #include "uart.h"
+#include "dma.h"
 
 // Test helper macros
 #define TEST_PASS() uart_puts("  ✓ PASS\n\n")
 #define TEST_FAIL() uart_puts("  ✗ FAIL\n\n")
 
+// Well below the store capacity: sequential nonces spread evenly over the sets
+#define STORE_TEST_PACKETS  128
+
+// Batch test: one received burst, validated with two DMA transfers
+#define BATCH_PACKETS       REPLAY_BATCH_DEPTH
+#define BATCH_PEERS         4
+
+struct replay_req {
+    unsigned int context;
+    unsigned int counter;
+    unsigned int nonce;
+};
+
+static struct replay_req batch_req[BATCH_PACKETS];
+static unsigned int batch_res[BATCH_PACKETS];
+
+// Authenticated packet: HMAC over counter, nonce and payload, then the tag
+#define PKT_PEER            7
+
+struct auth_packet {
+    unsigned int counter;
+    unsigned int nonce;
+    unsigned int payload[6];
+    unsigned int tag[8];
+};
+
+static struct auth_packet auth_pkt;
+
+// Nonce burst: half the nonce FIFO, read by DMA from the fixed NONCE address
+#define NONCE_BURST         (NONCE_FIFO_DEPTH / 2)
+
+static unsigned int nonce_burst[NONCE_BURST];
+
 void print_test_header(int num, const char* name) {
     uart_puts("=========================================\n");
     uart_puts("TEST ");
@@ -24,6 +58,63 @@ void print_separator() {
     uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
 }
 
+// Validate one packet and wait for the result (0 on timeout)
+static unsigned int replay_check(unsigned int counter, unsigned int nonce) {
+    REPLAY_CHECK_COUNTER = counter;
+    REPLAY_CHECK_NONCE = nonce;
+    REPLAY_VALIDATE = 1;
+
+    unsigned int timeout = 1000;
+    unsigned int status;
+    do {
+        status = REPLAY_STATUS;
+        timeout--;
+    } while (!(status & REPLAY_STATUS_READY) && timeout > 0);
+
+    return timeout ? status : 0;
+}
+
+// Run one crypto operation and wait for DONE (0 on timeout)
+static unsigned int crypto_run(unsigned int mode) {
+    CRYPTO_MODE = mode;
+    CRYPTO_CTRL = CRYPTO_CTRL_START;
+
+    unsigned int timeout = 100000;
+    unsigned int status;
+    do {
+        status = CRYPTO_STATUS;
+        timeout--;
+    } while (!(status & CRYPTO_STATUS_DONE) && timeout > 0);
+
+    return timeout ? status : 0;
+}
+
+// Tag the packet with the accelerator's own HMAC
+static void auth_packet_sign(struct auth_packet *pkt) {
+    CRYPTO_MSG_ADDR = (unsigned int)pkt;
+    CRYPTO_MSG_LEN = sizeof(pkt->counter) + sizeof(pkt->nonce) + sizeof(pkt->payload);
+    crypto_run(CRYPTO_MODE_HMAC_SHA256);
+
+    volatile unsigned int *hash = &CRYPTO_HASH_0;
+    for (int i = 0; i < 8; i++) {
+        pkt->tag[i] = hash[i];
+    }
+}
+
+// Fused tag check + freshness commit, returns CRYPTO_PKT_RESULT
+static unsigned int auth_packet_check(struct auth_packet *pkt, unsigned int peer) {
+    CRYPTO_PKT_ADDR = (unsigned int)pkt;
+    CRYPTO_PKT_LEN = sizeof(*pkt);
+    CRYPTO_PKT_TAG_OFF = (unsigned int)((char *)pkt->tag - (char *)pkt);
+    CRYPTO_PKT_FIELDS = CRYPTO_PKT_FIELDS_OF(0, sizeof(pkt->counter));
+    CRYPTO_PKT_CONTEXT = peer;
+
+    if (!crypto_run(CRYPTO_MODE_PACKET)) {
+        return 0;
+    }
+    return CRYPTO_PKT_RESULT;
+}
+
 int main() {
     uart_puts("\n\n");
     print_separator();
@@ -34,7 +125,7 @@ int main() {
     
     uart_puts("Testing hardware components:\n");
     uart_puts("  1. Monotonic Counter\n");
-    uart_puts("  2. Nonce Generator (LFSR)\n");
+    uart_puts("  2. Nonce Generator (SHA-256 DRBG)\n");
     uart_puts("  3. Anti-Replay Validation Engine\n\n");
     
     //=========================================================================
@@ -65,8 +156,22 @@ int main() {
     uart_puts("\n  Final counter: ");
     uart_puthex(final);
     uart_puts("\n");
-    
-    if (final == initial + 5) {
+
+    // One-load sequence numbers: single, then a block of 8
+    COUNTER_RESERVE_N = 8;
+    unsigned int seq = COUNTER_INC_AND_READ;
+    unsigned int block = COUNTER_RESERVE;
+    unsigned int after_block = COUNTER_INC_AND_READ;
+    uart_puts("  INC_AND_READ: ");
+    uart_puthex(seq);
+    uart_puts("  RESERVE(8): ");
+    uart_puthex(block);
+    uart_puts("  next: ");
+    uart_puthex(after_block);
+    uart_puts("\n");
+
+    if (final == initial + 5 && seq == final + 1 && block == final + 2 &&
+        after_block == final + 10 && COUNTER_VALUE_HI == 0) {
         TEST_PASS();
     } else {
         TEST_FAIL();
@@ -129,13 +234,14 @@ int main() {
     
     uart_puts("  Attempting to increment locked counter...\n");
     COUNTER_CTRL = COUNTER_CTRL_INCREMENT;
+    unsigned int locked_seq = COUNTER_INC_AND_READ;
     
     unsigned int after_lock = COUNTER_VALUE;
     uart_puts("  Counter after lock: ");
     uart_puthex(after_lock);
     uart_puts("\n\n");
     
-    if (after_lock == before_lock) {
+    if (after_lock == before_lock && locked_seq == 0) {
         uart_puts("  ✓ Counter is immutable after lock!\n");
         TEST_PASS();
     } else {
@@ -396,6 +502,313 @@ int main() {
     uart_puts("  ✓ Valid sequence accepted!\n");
     TEST_PASS();
     
+    //=========================================================================
+    // TEST 9: Anti-Replay Engine - Nonce Store Capacity
+    //=========================================================================
+    print_test_header(9, "Anti-Replay - Nonce Store Capacity");
+    uart_puts("  Capacity: ");
+    uart_puthex(REPLAY_CACHE_CAPACITY);
+    uart_puts(" nonces\n");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+
+    unsigned int accepted = 0;
+    for (unsigned int i = 0; i < STORE_TEST_PACKETS; i++) {
+        if (replay_check(1 + i, 0xA0000000 + i) & REPLAY_STATUS_VALID) {
+            accepted++;
+        }
+    }
+
+    // Replay every nonce with a fresh counter: only the nonce check can catch it
+    unsigned int caught = 0;
+    for (unsigned int i = 0; i < STORE_TEST_PACKETS; i++) {
+        if (replay_check(0x1000 + i, 0xA0000000 + i) & REPLAY_STATUS_BAD_NONCE) {
+            caught++;
+        }
+    }
+
+    uart_puts("  Accepted: ");
+    uart_puthex(accepted);
+    uart_puts("  Stored: ");
+    uart_puthex(REPLAY_CACHE_SIZE);
+    uart_puts("  Replays caught: ");
+    uart_puthex(caught);
+    uart_puts("\n\n");
+
+    if (accepted == STORE_TEST_PACKETS && caught == STORE_TEST_PACKETS &&
+        REPLAY_CACHE_SIZE == STORE_TEST_PACKETS) {
+        uart_puts("  ✓ All nonces remembered!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Nonce store lost entries!\n");
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 10: Anti-Replay Engine - Sliding Window (reordered link)
+    //=========================================================================
+    print_test_header(10, "Anti-Replay - Sliding Window");
+    unsigned int win = REPLAY_WINDOW_SIZE;
+    uart_puts("  Window: ");
+    uart_puthex(win);
+    uart_puts(" counters, nonce store off\n\n");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_WINDOW | REPLAY_CTRL_NONCE_OFF;
+
+    // Reordered but fresh packets are accepted, duplicates and packets
+    // older than the window are not
+    int window_ok =
+        (replay_check(5, 0) & REPLAY_STATUS_VALID) &&
+        (replay_check(3, 0) & REPLAY_STATUS_VALID) &&
+        (replay_check(4, 0) & REPLAY_STATUS_VALID) &&
+        (replay_check(3, 0) & REPLAY_STATUS_BAD_COUNTER) &&
+        (replay_check(5, 0) & REPLAY_STATUS_BAD_COUNTER) &&
+        (replay_check(5 + win, 0) & REPLAY_STATUS_VALID) &&
+        (replay_check(5, 0) & REPLAY_STATUS_BAD_COUNTER) &&
+        (replay_check(6, 0) & REPLAY_STATUS_VALID) &&
+        (replay_check(4 + win, 0) & REPLAY_STATUS_VALID) &&
+        REPLAY_LAST_COUNTER == 5 + win;
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+
+    if (window_ok) {
+        uart_puts("  ✓ Out-of-order packets accepted, replays rejected!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Window check wrong!\n");
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 11: Anti-Replay Engine - Per-Peer Contexts
+    //=========================================================================
+    print_test_header(11, "Anti-Replay - Per-Peer Contexts");
+    uart_puts("  Contexts: ");
+    uart_puthex(REPLAY_NUM_CONTEXTS);
+    uart_puts("\n\n");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+
+    // Two peers with their own counters; the same nonce is fresh for each
+    REPLAY_CONTEXT_ID = 1;
+    int ctx_ok = (replay_check(100, 0xC0FFEE00) & REPLAY_STATUS_VALID) != 0;
+    REPLAY_CONTEXT_ID = 2;
+    ctx_ok = ctx_ok && (replay_check(50, 0xC0FFEE00) & REPLAY_STATUS_VALID);
+    ctx_ok = ctx_ok && REPLAY_LAST_COUNTER == 50;
+    REPLAY_CONTEXT_ID = 1;
+    ctx_ok = ctx_ok && REPLAY_LAST_COUNTER == 100;
+    ctx_ok = ctx_ok && (replay_check(100, 0xC0FFEE01) & REPLAY_STATUS_BAD_COUNTER);
+    ctx_ok = ctx_ok && (replay_check(101, 0xC0FFEE00) & REPLAY_STATUS_BAD_NONCE);
+
+    // Re-pairing peer 2 leaves peer 1 alone
+    REPLAY_CONTEXT_ID = 2;
+    REPLAY_CTRL = REPLAY_CTRL_RESET_CONTEXT;
+    ctx_ok = ctx_ok && REPLAY_LAST_COUNTER == 0;
+    REPLAY_CONTEXT_ID = 1;
+    ctx_ok = ctx_ok && REPLAY_LAST_COUNTER == 100;
+    REPLAY_CONTEXT_ID = 0;
+
+    if (ctx_ok) {
+        uart_puts("  ✓ Peers tracked independently!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Peer state mixed up!\n");
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 12: Anti-Replay Engine - Batched Validation via DMA
+    //=========================================================================
+    print_test_header(12, "Anti-Replay - Batched Validation");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE | REPLAY_CTRL_FLUSH;
+
+    // Burst from four peers; the last packet replays the first one
+    for (unsigned int i = 0; i < BATCH_PACKETS - 1; i++) {
+        batch_req[i].context = i % BATCH_PEERS;
+        batch_req[i].counter = 1000 + i;
+        batch_req[i].nonce   = 0xB0000000 + i;
+    }
+    batch_req[BATCH_PACKETS - 1] = batch_req[0];
+
+    // Descriptors in, results out: both through fixed-address FIFO registers
+    int batch_ok = dma_copy((void *)&REPLAY_REQ_PUSH, batch_req, sizeof(batch_req)) == 0;
+    while (REPLAY_BATCH_STATUS & REPLAY_BATCH_BUSY);
+    uart_puts("  Results queued: ");
+    uart_puthex(REPLAY_BATCH_RESULTS(REPLAY_BATCH_STATUS));
+    uart_puts("\n");
+
+    DMA_SRC = (unsigned int)&REPLAY_RESULT_POP;
+    DMA_DST = (unsigned int)batch_res;
+    DMA_LEN = sizeof(batch_res);
+    DMA_CTRL = DMA_CTRL_START | DMA_CTRL_SRC_FIXED;
+    batch_ok = batch_ok && dma_wait() == 0;
+
+    unsigned int batch_valid = 0;
+    for (unsigned int i = 0; i < BATCH_PACKETS; i++) {
+        if ((batch_res[i] & REPLAY_RESULT_PRESENT) &&
+            (batch_res[i] & REPLAY_STATUS_VALID) &&
+            REPLAY_RESULT_CONTEXT(batch_res[i]) == batch_req[i].context) {
+            batch_valid++;
+        }
+    }
+    unsigned int last = batch_res[BATCH_PACKETS - 1];
+
+    uart_puts("  Accepted: ");
+    uart_puthex(batch_valid);
+    uart_puts("  Last result: ");
+    uart_puthex(last);
+    uart_puts("\n\n");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+
+    if (batch_ok && batch_valid == BATCH_PACKETS - 1 &&
+        (last & REPLAY_RESULT_PRESENT) && (last & REPLAY_STATUS_REPLAY) &&
+        !(REPLAY_BATCH_STATUS & REPLAY_BATCH_OVERFLOW)) {
+        uart_puts("  ✓ Burst validated in hardware, replay caught!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Batch validation wrong!\n");
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 13: Authenticated Packet Check (HMAC + anti-replay, one command)
+    //=========================================================================
+    print_test_header(13, "Anti-Replay - Authenticated Packets");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+    REPLAY_CONTEXT_ID = PKT_PEER;
+
+    // Packet key (the boot ROM's firmware key is no longer needed)
+    volatile unsigned int *key = &CRYPTO_KEY_0;
+    for (int i = 0; i < 8; i++) {
+        key[i] = 0x5A5A0000 + i;
+    }
+
+    auth_pkt.counter = 5000;
+    auth_pkt.nonce = NONCE_VALUE;
+    for (int i = 0; i < 6; i++) {
+        auth_pkt.payload[i] = 0x0FF1CE00 + i;
+    }
+    auth_packet_sign(&auth_pkt);
+
+    unsigned int fresh = auth_packet_check(&auth_pkt, PKT_PEER);
+    unsigned int replay = auth_packet_check(&auth_pkt, PKT_PEER);
+
+    // Forged packet with a higher counter: must not advance LAST_COUNTER
+    auth_pkt.counter = 6000;
+    auth_pkt.nonce = NONCE_VALUE;
+    auth_packet_sign(&auth_pkt);
+    auth_pkt.payload[0] ^= 0x1;
+    unsigned int forged = auth_packet_check(&auth_pkt, PKT_PEER);
+    unsigned int last_after_forged = REPLAY_LAST_COUNTER;
+
+    // The genuine packet is still accepted afterwards
+    auth_pkt.payload[0] ^= 0x1;
+    unsigned int genuine = auth_packet_check(&auth_pkt, PKT_PEER);
+
+    // Peer past the last context (same low bits as PKT_PEER): refused
+    // before the HMAC, nothing committed
+    auth_pkt.counter = 7000;
+    auth_pkt.nonce = NONCE_VALUE;
+    auth_packet_sign(&auth_pkt);
+    unsigned int bad_peer = auth_packet_check(&auth_pkt, PKT_PEER + REPLAY_NUM_CONTEXTS);
+    unsigned int last_after_bad_peer = REPLAY_LAST_COUNTER;
+
+    uart_puts("  Fresh: ");
+    uart_puthex(fresh);
+    uart_puts("  Replayed: ");
+    uart_puthex(replay);
+    uart_puts("\n  Forged: ");
+    uart_puthex(forged);
+    uart_puts("  Genuine: ");
+    uart_puthex(genuine);
+    uart_puts("\n  LAST_COUNTER after forged packet: ");
+    uart_puthex(last_after_forged);
+    uart_puts("\n  Unknown peer: ");
+    uart_puthex(bad_peer);
+    uart_puts("  LAST_COUNTER after it: ");
+    uart_puthex(last_after_bad_peer);
+    uart_puts("\n\n");
+
+    REPLAY_CTRL = REPLAY_CTRL_RESET_STATE | REPLAY_CTRL_RESET_CACHE;
+    REPLAY_CONTEXT_ID = 0;
+
+    if (fresh == REPLAY_STATUS_VALID &&
+        (replay & REPLAY_STATUS_REPLAY) &&
+        forged == CRYPTO_PKT_BAD_TAG &&
+        last_after_forged == 5000 &&
+        genuine == REPLAY_STATUS_VALID &&
+        bad_peer == CRYPTO_PKT_BAD_DESC &&
+        last_after_bad_peer == 6000) {
+        uart_puts("  ✓ Only authenticated, fresh packets committed!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Authenticated packet check wrong!\n");
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 14: Nonce Generator - Burst Reads (DRBG FIFO)
+    //=========================================================================
+    print_test_header(14, "Nonce Generator - Burst Reads");
+
+    NONCE_STATUS = NONCE_STATUS_UNDERFLOW;
+    NONCE_CTRL = NONCE_CTRL_ENABLE | NONCE_CTRL_READ_ADVANCE;
+
+    // Back-to-back reads: one 128-bit nonce
+    unsigned int wide[4];
+    wide[0] = NONCE_VALUE;
+    wide[1] = NONCE_VALUE;
+    wide[2] = NONCE_VALUE;
+    wide[3] = NONCE_VALUE;
+
+    // DMA drains the FIFO as fast as the bus allows
+    DMA_SRC = (unsigned int)&NONCE_VALUE;
+    DMA_DST = (unsigned int)nonce_burst;
+    DMA_LEN = sizeof(nonce_burst);
+    DMA_CTRL = DMA_CTRL_START | DMA_CTRL_SRC_FIXED;
+    int burst_ok = dma_wait() == 0;
+
+    unsigned int nonce_dups = 0;
+    for (int i = 0; i < NONCE_BURST; i++) {
+        for (int j = 0; j < i; j++) {
+            if (nonce_burst[i] == nonce_burst[j]) {
+                nonce_dups++;
+            }
+        }
+        for (int j = 0; j < 4; j++) {
+            if (nonce_burst[i] == wide[j]) {
+                nonce_dups++;
+            }
+        }
+    }
+    for (int i = 1; i < 4; i++) {
+        if (wide[i] == wide[i - 1]) {
+            nonce_dups++;
+        }
+    }
+    unsigned int nonce_status = NONCE_STATUS;
+
+    uart_puts("  128-bit nonce: ");
+    for (int i = 3; i >= 0; i--) {
+        uart_puthex(wide[i]);
+    }
+    uart_puts("\n  Duplicates: ");
+    uart_puthex(nonce_dups);
+    uart_puts("  Status: ");
+    uart_puthex(nonce_status);
+    uart_puts("\n\n");
+
+    if (burst_ok && nonce_dups == 0 && !(nonce_status & NONCE_STATUS_UNDERFLOW)) {
+        uart_puts("  ✓ Every read fresh, no stall!\n");
+        TEST_PASS();
+    } else {
+        uart_puts("  ✗ Nonce burst wrong!\n");
+        TEST_FAIL();
+    }
+
     //=========================================================================
     // SUMMARY
     //=========================================================================
@@ -0,0 +1,207 @@
+/*
+ * DMA Controller Test Suite
+ *
+ * Tests the DMA copy/fill engine, its error reporting and completion
+ * IRQ, and the .data/.bss setup done by start.S through the DMA.
+ */
+
+#include "soc_map.h"
+#include "uart.h"
+#include "irq.h"
+#include "dma.h"
+#include "hart.h"
+
+// Test helper macros
+#define TEST_PASS() uart_puts("  ✓ PASS\n\n")
+#define TEST_FAIL() uart_puts("  ✗ FAIL\n\n")
+
+#define BUF_WORDS       256
+#define WAIT_TIMEOUT    200000
+
+// Initialized data: copied from flash by start.S
+static unsigned int data_pattern[4] = { 0x11111111, 0x22222222, 0x33333333, 0x44444444 };
+
+// Zero-initialized data: cleared by start.S
+static unsigned int bss_words[16];
+
+static unsigned int src_buf[BUF_WORDS];
+static unsigned int dst_buf[BUF_WORDS];
+
+static volatile unsigned int dma_events;
+
+void print_test_header(int num, const char* name) {
+    uart_puts("=========================================\n");
+    uart_puts("TEST ");
+    uart_puthex(num);
+    uart_puts(": ");
+    uart_puts(name);
+    uart_puts("\n=========================================\n");
+}
+
+void print_separator() {
+    uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+}
+
+static void dma_handler(unsigned int src) {
+    (void)src;
+    DMA_STATUS = DMA_STATUS_DONE;
+    dma_events++;
+}
+
+static int buffers_match(unsigned int words) {
+    for (unsigned int i = 0; i < words; i++) {
+        if (dst_buf[i] != src_buf[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main() {
+    int failures = 0;
+    unsigned int start;
+    unsigned int cpu_cycles;
+    unsigned int dma_cycles;
+    int ok;
+
+    uart_puts("\n\n");
+    print_separator();
+    uart_puts("  DMA CONTROLLER TEST SUITE\n");
+    print_separator();
+    uart_puts("\n");
+
+    //=========================================================================
+    // TEST 1: Startup .data copy and .bss clear
+    //=========================================================================
+    print_test_header(1, "Startup .data/.bss via DMA");
+    ok = (data_pattern[0] == 0x11111111 && data_pattern[3] == 0x44444444);
+    for (int i = 0; i < 16; i++) {
+        if (bss_words[i] != 0) {
+            ok = 0;
+        }
+    }
+    if (ok) {
+        uart_puts("  .data initialized, .bss zeroed\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 2: Memory-to-memory copy vs. CPU loop
+    //=========================================================================
+    print_test_header(2, "Copy 1KB RAM to RAM");
+    for (int i = 0; i < BUF_WORDS; i++) {
+        src_buf[i] = (i << 16) ^ 0xA5A50000 ^ i;
+    }
+
+    start = rdcycle();
+    for (int i = 0; i < BUF_WORDS; i++) {
+        dst_buf[i] = src_buf[i];
+    }
+    cpu_cycles = rdcycle() - start;
+
+    dma_fill(dst_buf, 0, sizeof(dst_buf));
+
+    start = rdcycle();
+    ok = (dma_copy(dst_buf, src_buf, sizeof(src_buf)) == 0);
+    dma_cycles = rdcycle() - start;
+
+    uart_puts("  CPU cycles: ");
+    uart_puthex(cpu_cycles);
+    uart_puts("\n  DMA cycles: ");
+    uart_puthex(dma_cycles);
+    uart_puts("\n");
+    if (ok && buffers_match(BUF_WORDS)) {
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 3: Fill
+    //=========================================================================
+    print_test_header(3, "Fill with pattern");
+    ok = (dma_fill(dst_buf, 0xDEADBEEF, 64) == 0);
+    for (int i = 0; i < 16; i++) {
+        if (dst_buf[i] != 0xDEADBEEF) {
+            ok = 0;
+        }
+    }
+    // Word after the fill must be untouched
+    if (dst_buf[16] != src_buf[16]) {
+        ok = 0;
+    }
+    if (ok) {
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 4: Misaligned request rejected
+    //=========================================================================
+    print_test_header(4, "Misaligned request");
+    if (dma_copy(dst_buf, (unsigned char *)src_buf + 2, 16) != 0 &&
+        dst_buf[0] == 0xDEADBEEF) {
+        uart_puts("  ERROR set, memory untouched\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 5: MPU violation reported to the DMA
+    //=========================================================================
+    print_test_header(5, "Write to firmware region");
+    // Firmware is read-only: the write is dropped and the DMA stops
+    // with ERROR instead of trapping the CPU
+    if (dma_fill((void *)(INSTR_MEM_BASE + 0x8000), 0, 16) != 0 &&
+        DMA_REMAINING == 16) {
+        uart_puts("  Blocked by MPU, ERROR set\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 6: Completion interrupt
+    //=========================================================================
+    print_test_header(6, "DMA DONE IRQ");
+    irq_init();
+    irq_register(IRQ_SRC_DMA, dma_handler);
+    irq_enable(IRQ_SRC_DMA);
+
+    dma_start_copy(dst_buf, src_buf, sizeof(src_buf), DMA_CTRL_IRQ_EN);
+    for (unsigned int t = WAIT_TIMEOUT; dma_events == 0 && t > 0; t--);
+    irq_disable(IRQ_SRC_DMA);
+
+    if (dma_events == 1 && buffers_match(BUF_WORDS)) {
+        uart_puts("  Copy completion signalled by IRQ\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // SUMMARY
+    //=========================================================================
+    print_separator();
+    uart_puts("  TEST SUITE COMPLETE\n");
+    print_separator();
+    uart_puts("  Failures: ");
+    uart_puthex(failures);
+    uart_puts("\n\n");
+
+    // Signal end of simulation with EOT (0x04)
+    uart_putc(0x04);
+
+    while(1);
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+ * Dual-Core Packet Validation Demo
+ *
+ * Splits packet validation across both harts of a DUAL_CORE build:
+ *   1. Take the next packet from a shared queue and check its counter
+ *      and nonce with the anti-replay engine (under MUTEX_ANTI_REPLAY,
+ *      so packets reach the engine in counter order).
+ *   2. Verify the payload tag in software (outside the lock, in parallel
+ *      on both harts).
+ *
+ * The same packet set is processed once by hart 0 alone and once by
+ * both harts; cycles are measured with rdcycle.
+ *
+ * Build:    make clean all FW_TEST=test_dual_core
+ * Simulate: DUAL_CORE=1 ./scripts/simulate.sh
+ */
+
+#include "soc_map.h"
+#include "uart.h"
+#include "hart.h"
+
+#define NUM_PACKETS     32
+#define PAYLOAD_WORDS   16
+#define TAG_ROUNDS      4
+
+typedef struct {
+    unsigned int counter;
+    unsigned int nonce;
+    unsigned int payload[PAYLOAD_WORDS];
+    unsigned int tag;
+} packet_t;
+
+static packet_t packets[NUM_PACKETS];
+
+// Shared work queue (guarded by MUTEX_ANTI_REPLAY)
+static volatile unsigned int next_packet;
+static volatile unsigned int accepted;
+
+// Per-hart results
+static volatile unsigned int processed[2];
+static volatile unsigned int tag_ok[2];
+
+// Hart 0 -> hart 1 handshake
+static volatile unsigned int hart1_ready;
+static volatile unsigned int run_id;
+static volatile unsigned int hart1_done;
+
+void print_separator() {
+    uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+}
+
+//=========================================================================
+// Packet processing
+//=========================================================================
+static unsigned int compute_tag(const unsigned int *payload) {
+    unsigned int h = 0x811C9DC5;
+    for (int r = 0; r < TAG_ROUNDS; r++) {
+        for (int i = 0; i < PAYLOAD_WORDS; i++) {
+            h ^= payload[i] + r;
+            h = (h << 5) + (h >> 27) + 0x9E3779B9;
+        }
+    }
+    return h;
+}
+
+static void prepare_packets(void) {
+    NONCE_CTRL = NONCE_CTRL_ENABLE | NONCE_CTRL_READ_ADVANCE;
+    for (int p = 0; p < NUM_PACKETS; p++) {
+        packets[p].counter = p + 1;
+        packets[p].nonce = NONCE_VALUE;
+        for (int i = 0; i < PAYLOAD_WORDS; i++) {
+            packets[p].payload[i] = (p << 16) ^ (i * 0x01010101);
+        }
+        packets[p].tag = compute_tag(packets[p].payload);
+    }
+}
+
+static void reset_run(void) {
+    REPLAY_CTRL = REPLAY_CTRL_RESET_CACHE | REPLAY_CTRL_RESET_STATE;
+    next_packet = 0;
+    accepted = 0;
+    processed[0] = processed[1] = 0;
+    tag_ok[0] = tag_ok[1] = 0;
+}
+
+// Worker loop shared by both harts
+static void validate_packets(unsigned int hart) {
+    while (1) {
+        unsigned int idx;
+        unsigned int status;
+
+        mutex_lock(MUTEX_ANTI_REPLAY);
+        idx = next_packet;
+        if (idx >= NUM_PACKETS) {
+            mutex_unlock(MUTEX_ANTI_REPLAY);
+            break;
+        }
+        next_packet = idx + 1;
+
+        REPLAY_CHECK_COUNTER = packets[idx].counter;
+        REPLAY_CHECK_NONCE = packets[idx].nonce;
+        REPLAY_VALIDATE = 1;
+        while (!((status = REPLAY_STATUS) & REPLAY_STATUS_READY));
+        if (status & REPLAY_STATUS_VALID) {
+            accepted++;
+        }
+        mutex_unlock(MUTEX_ANTI_REPLAY);
+
+        processed[hart]++;
+        if ((status & REPLAY_STATUS_VALID) &&
+            compute_tag(packets[idx].payload) == packets[idx].tag) {
+            tag_ok[hart]++;
+        }
+    }
+}
+
+//=========================================================================
+// Hart 1 entry (called from start.S)
+//=========================================================================
+void secondary_main(void) {
+    unsigned int seen = 0;
+
+    hart1_ready = 1;
+    while (1) {
+        while (run_id == seen);
+        seen = run_id;
+        validate_packets(1);
+        hart1_done = seen;
+    }
+}
+
+static void print_result(const char *name, unsigned int cycles) {
+    uart_puts(name);
+    uart_puts("\n  Cycles:   ");
+    uart_puthex(cycles);
+    uart_puts("\n  Accepted: ");
+    uart_puthex(accepted);
+    uart_puts("\n  Hart 0:   ");
+    uart_puthex(processed[0]);
+    uart_puts(" packets, ");
+    uart_puthex(tag_ok[0]);
+    uart_puts(" tags OK\n  Hart 1:   ");
+    uart_puthex(processed[1]);
+    uart_puts(" packets, ");
+    uart_puthex(tag_ok[1]);
+    uart_puts(" tags OK\n  Packets per 1000 cycles (x100): ");
+    uart_puthex((NUM_PACKETS * 100000u) / cycles);
+    uart_puts("\n\n");
+}
+
+int main() {
+    unsigned int start;
+    unsigned int single_cycles;
+    unsigned int dual_cycles = 0;
+    unsigned int harts = hart_count();
+
+    uart_puts("\n\n");
+    print_separator();
+    uart_puts("  DUAL-CORE PACKET VALIDATION DEMO\n");
+    print_separator();
+    uart_puts("  Harts: ");
+    uart_puthex(harts);
+    uart_puts("\n  Packets: ");
+    uart_puthex(NUM_PACKETS);
+    uart_puts("\n\n");
+
+    prepare_packets();
+
+    //=========================================================================
+    // Run 1: hart 0 only (hart 1 still parked in the boot ROM)
+    //=========================================================================
+    reset_run();
+    start = rdcycle();
+    validate_packets(0);
+    single_cycles = rdcycle() - start;
+    print_result("Single hart:", single_cycles);
+
+    //=========================================================================
+    // Run 2: both harts
+    //=========================================================================
+    if (harts > 1) {
+        hart_start(1);
+        while (!hart1_ready);
+
+        reset_run();
+        start = rdcycle();
+        run_id = 1;
+        validate_packets(0);
+        while (hart1_done != 1);
+        dual_cycles = rdcycle() - start;
+        print_result("Two harts:", dual_cycles);
+
+        uart_puts("Speedup (x100): ");
+        uart_puthex((single_cycles * 100u) / dual_cycles);
+        uart_puts("\n\n");
+    } else {
+        uart_puts("Single-core build: rerun with DUAL_CORE=1 for the two-hart result\n\n");
+    }
+
+    print_separator();
+    uart_puts("  TEST SUITE COMPLETE\n");
+    print_separator();
+    uart_puts("\n");
+
+    // Signal end of simulation with EOT (0x04)
+    uart_putc(0x04);
+
+    while(1);
+    return 0;
+}
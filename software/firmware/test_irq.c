@@ -0,0 +1,324 @@
+/*
+ * Interrupt Controller Test Suite
+ *
+ * Tests the interrupt controller, timer peripheral and the IRQ path
+ * through the boot ROM vector and start.S into irq_dispatch().
+ */
+
+#include "soc_map.h"
+#include "uart.h"
+#include "irq.h"
+
+// Test helper macros
+#define TEST_PASS() uart_puts("  ✓ PASS\n\n")
+#define TEST_FAIL() uart_puts("  ✗ FAIL\n\n")
+
+#define TIMER_PERIOD    2000    // Cycles between timer IRQs
+#define TIMER_TICKS     5
+#define WAIT_TIMEOUT    200000
+
+static volatile unsigned int timer_ticks;
+static volatile unsigned int uart_events;
+static volatile unsigned int crypto_events;
+static volatile unsigned int replay_events;
+static volatile unsigned int forced_events;
+
+void print_test_header(int num, const char* name) {
+    uart_puts("=========================================\n");
+    uart_puts("TEST ");
+    uart_puthex(num);
+    uart_puts(": ");
+    uart_puts(name);
+    uart_puts("\n=========================================\n");
+}
+
+void print_separator() {
+    uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+}
+
+//=========================================================================
+// Handlers
+//=========================================================================
+static void timer_handler(unsigned int src) {
+    (void)src;
+    TIMER_STATUS = TIMER_STATUS_MATCH;
+    timer_ticks++;
+}
+
+static volatile unsigned int uart_irq_level;
+static volatile unsigned int uart_rx_events;
+static volatile unsigned int uart_dma_events;
+
+static void uart_handler(unsigned int src) {
+    (void)src;
+    uart_irq_level = UART_TX_LEVEL(UART_STATUS_REG);
+    uart_events++;
+}
+
+static void uart_rx_handler(unsigned int src) {
+    (void)src;
+    // Level source: mask it until the FIFO has been read
+    irq_disable(IRQ_SRC_UART_RX);
+    uart_rx_events++;
+}
+
+static void uart_dma_handler(unsigned int src) {
+    (void)src;
+    UART_DMA_STATUS = UART_DMA_DONE;
+    uart_dma_events++;
+}
+
+static void crypto_handler(unsigned int src) {
+    (void)src;
+    crypto_events++;
+}
+
+static void replay_handler(unsigned int src) {
+    (void)src;
+    replay_events++;
+}
+
+static void forced_handler(unsigned int src) {
+    (void)src;
+    forced_events++;
+}
+
+static int wait_for(volatile unsigned int *counter, unsigned int target) {
+    unsigned int timeout = WAIT_TIMEOUT;
+    while (*counter < target && timeout > 0) {
+        timeout--;
+    }
+    return *counter >= target;
+}
+
+int main() {
+    int failures = 0;
+
+    uart_puts("\n\n");
+    print_separator();
+    uart_puts("  INTERRUPT CONTROLLER TEST SUITE\n");
+    print_separator();
+    uart_puts("\n");
+
+    irq_init();
+
+    //=========================================================================
+    // TEST 1: Software-forced interrupt
+    //=========================================================================
+    print_test_header(1, "Forced IRQ through controller");
+    irq_register(7, forced_handler);
+    irq_enable(7);
+    IRQC_FORCE = (1u << 7);
+    if (wait_for(&forced_events, 1) && !(IRQC_PENDING & (1u << 7))) {
+        uart_puts("  Handler ran and PENDING was cleared\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+    irq_disable(7);
+
+    //=========================================================================
+    // TEST 2: Periodic timer interrupt
+    //=========================================================================
+    print_test_header(2, "Periodic timer IRQ");
+    irq_register(IRQ_SRC_TIMER, timer_handler);
+    irq_enable(IRQ_SRC_TIMER);
+
+    TIMER_COUNT = 0;
+    TIMER_COMPARE = TIMER_PERIOD;
+    TIMER_CTRL = TIMER_CTRL_ENABLE | TIMER_CTRL_AUTO_RELOAD | TIMER_CTRL_IRQ_EN;
+
+    // Bounded: waitirq would never return if the timer IRQ is lost
+    int ticked = wait_for(&timer_ticks, TIMER_TICKS);
+    TIMER_CTRL = 0;
+    irq_disable(IRQ_SRC_TIMER);
+
+    uart_puts("  Ticks: ");
+    uart_puthex(timer_ticks);
+    uart_puts("\n");
+    if (ticked) {
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+
+    //=========================================================================
+    // TEST 3: Crypto done interrupt
+    //=========================================================================
+    print_test_header(3, "Crypto DONE IRQ");
+    irq_register(IRQ_SRC_CRYPTO, crypto_handler);
+    irq_enable(IRQ_SRC_CRYPTO);
+
+    CRYPTO_MSG_ADDR = INSTR_MEM_BASE;
+    CRYPTO_MSG_LEN = 64;
+    CRYPTO_MODE = CRYPTO_MODE_HMAC_SHA256;
+    CRYPTO_CTRL = CRYPTO_CTRL_START;
+
+    if (wait_for(&crypto_events, 1)) {
+        uart_puts("  HMAC completion signalled by IRQ\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+    irq_disable(IRQ_SRC_CRYPTO);
+
+    //=========================================================================
+    // TEST 4: Anti-replay validation interrupt
+    //=========================================================================
+    print_test_header(4, "Anti-replay validation IRQ");
+    irq_register(IRQ_SRC_ANTI_REPLAY, replay_handler);
+    irq_enable(IRQ_SRC_ANTI_REPLAY);
+
+    REPLAY_CHECK_COUNTER = REPLAY_LAST_COUNTER + 1;
+    REPLAY_CHECK_NONCE = NONCE_VALUE;
+    REPLAY_VALIDATE = 1;
+
+    if (wait_for(&replay_events, 1)) {
+        uart_puts("  Validation completion signalled by IRQ\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+    irq_disable(IRQ_SRC_ANTI_REPLAY);
+
+    //=========================================================================
+    // TEST 5: UART TX threshold interrupt
+    //=========================================================================
+    print_test_header(5, "UART TX threshold IRQ");
+    uart_flush();
+    UART_TX_THRESH = 8;
+
+    // Queue past the threshold, then enable: the IRQ fires once the FIFO
+    // has drained below 8 characters
+    for (int i = 0; i < 16; i++) {
+        uart_putc('*');
+    }
+    IRQC_PENDING = 1u << IRQ_SRC_UART;
+    irq_register(IRQ_SRC_UART, uart_handler);
+    irq_enable(IRQ_SRC_UART);
+
+    if (wait_for(&uart_events, 1) && uart_irq_level < 8) {
+        uart_puts("\n  TX below threshold signalled by IRQ, level ");
+        uart_puthex(uart_irq_level);
+        uart_puts("\n");
+        TEST_PASS();
+    } else {
+        failures++;
+        TEST_FAIL();
+    }
+    irq_disable(IRQ_SRC_UART);
+    UART_TX_THRESH = 1;
+
+    //=========================================================================
+    // TEST 6: UART receive at 3 Mbaud
+    //=========================================================================
+    print_test_header(6, "UART RX FIFO IRQ at 3 Mbaud");
+    {
+        static const char expect[] = "HELLO RX";   // Sent by the testbench host
+        unsigned int saved_div = UART_BAUD_DIV;
+        unsigned int st;
+        char got[sizeof(expect)];
+        int n = 0;
+        int c;
+
+        uart_flush();
+        UART_BAUD_DIV = UART_BAUD_DIV_FOR(3000000);
+        UART_RX_THRESH = sizeof(expect) - 1;
+        UART_STATUS_REG = UART_RX_OVERRUN | UART_RX_FRAME_ERR;
+        IRQC_PENDING = 1u << IRQ_SRC_UART_RX;
+        irq_register(IRQ_SRC_UART_RX, uart_rx_handler);
+        irq_enable(IRQ_SRC_UART_RX);
+
+        uart_putc(0x05);    // ENQ: ask the host to send
+        wait_for(&uart_rx_events, 1);
+        st = UART_STATUS_REG;
+
+        while (n < (int)sizeof(got) - 1 && (c = uart_getc()) >= 0) {
+            got[n++] = (char)c;
+        }
+        got[n] = '\0';
+
+        uart_flush();
+        UART_BAUD_DIV = saved_div;
+        UART_RX_THRESH = 1;
+
+        uart_puts("  Received \"");
+        uart_puts(got);
+        uart_puts("\", status ");
+        uart_puthex(st);
+        uart_puts("\n");
+
+        int ok = uart_rx_events == 1 && n == (int)sizeof(expect) - 1 &&
+                 !(st & (UART_RX_OVERRUN | UART_RX_FRAME_ERR));
+        for (int i = 0; ok && i < n; i++) {
+            ok = got[i] == expect[i];
+        }
+        if (ok) {
+            TEST_PASS();
+        } else {
+            failures++;
+            TEST_FAIL();
+        }
+    }
+
+    //=========================================================================
+    // TEST 7: UART TX DMA with completion interrupt
+    //=========================================================================
+    print_test_header(7, "UART TX DMA done IRQ");
+    {
+        // Odd start and length: the UART reads whole words
+        static const char line[] = "  [DMA] log line sent by the UART itself\r\n";
+        unsigned int spins = 0;
+
+        uart_flush();
+        UART_DMA_STATUS = UART_DMA_DONE | UART_DMA_ERROR;
+        UART_DMA_CTRL = UART_DMA_CTRL_IRQ_EN;
+        IRQC_PENDING = 1u << IRQ_SRC_UART_DMA;
+        irq_register(IRQ_SRC_UART_DMA, uart_dma_handler);
+        irq_enable(IRQ_SRC_UART_DMA);
+
+        uart_write_dma(line + 1, sizeof(line) - 2);
+
+        // The CPU is free while the line goes out
+        while (uart_dma_events == 0 && spins < WAIT_TIMEOUT) {
+            spins++;
+        }
+        uart_flush();
+        irq_disable(IRQ_SRC_UART_DMA);
+        UART_DMA_CTRL = 0;
+
+        uart_puts("  Loop iterations during the job: ");
+        uart_puthex(spins);
+        uart_puts("\n");
+
+        if (uart_dma_events == 1 && spins > 0 &&
+            !(UART_DMA_STATUS & (UART_DMA_BUSY | UART_DMA_ERROR))) {
+            TEST_PASS();
+        } else {
+            failures++;
+            TEST_FAIL();
+        }
+    }
+
+    //=========================================================================
+    // SUMMARY
+    //=========================================================================
+    print_separator();
+    uart_puts("  TEST SUITE COMPLETE\n");
+    print_separator();
+    uart_puts("  Failures: ");
+    uart_puthex(failures);
+    uart_puts("\n  Spurious IRQs: ");
+    uart_puthex(irq_spurious_count());
+    uart_puts("\n\n");
+
+    // Signal end of simulation with EOT (0x04)
+    uart_putc(0x04);
+
+    while(1);
+    return 0;
+}
@@ -7,12 +7,39 @@
 
 #include "../common/soc_map.h"
 #include "../common/firmware_header.h"
+#include "../common/boot_log.h"
 
 extern void uart_putc(char c);
 extern void uart_puts(const char* s);
 extern void uart_puthex(unsigned int val);
+extern void uart_flush(void);
+
+// Second run, after the warm reset at the end of main()
+static void warm_boot_report(void) {
+    uart_puts("\nWarm Reboot:\n");
+    uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+    uart_puts("  IMEM dirty:     ");
+    uart_puts((BOOT_STATUS & BOOT_STATUS_IMEM_DIRTY) ? "yes ✗\n" : "no ✓\n");
+    uart_puts("  Cached digest:  ");
+    uart_puthex(IMEM_DIGEST(0));
+    uart_puts(IMEM_DIGEST(0) == GET_FW_HEADER()->signature[0] ? " ✓\n" : " ✗\n");
+    uart_puts("  Verified pages: ");
+    uart_puthex(PV_VERIFIED);
+    uart_puts(" (kept, not re-hashed)\n\n");
+    boot_log_dump();
+    uart_puts("\n");
+    uart_puts("Boot ROM reused the verified signature.\n\n");
+
+    uart_putc(0x04);
+    while (1) {
+    }
+}
 
 void main(void) {
+    if (BOOT_STATUS & BOOT_STATUS_WARM) {
+        warm_boot_report();
+    }
+
     uart_puts("\n\n");
     uart_puts("╔════════════════════════════════════════╗\n");
     uart_puts("║     SECURE BOOT SUCCESS! ✓             ║\n");
@@ -53,7 +80,16 @@ void main(void) {
     
     uart_puts("  Timestamp:  ");
     uart_puthex(header->timestamp);
-    uart_puts("\n\n");
+    uart_puts("\n");
+
+    // The boot ROM raised the floor to our version and locked it: a
+    // check from firmware fails and leaves it unchanged
+    uart_puts("  Ver. floor: ");
+    uart_puthex(VERSION_FLOOR);
+    uart_puts(VERSION_FLOOR == header->version ? " ✓" : " ✗");
+    VERSION_CHECK = header->version + 1;
+    uart_puts((VERSION_CHECK & VERSION_CHECK_OK) || VERSION_FLOOR != header->version ?
+              " (not locked ✗)\n\n" : " (locked ✓)\n\n");
     
     uart_puts("HMAC-SHA256 Signature:\n");
     uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
@@ -65,6 +101,51 @@ void main(void) {
         uart_puts("\n");
     }
     
+    // Pages the page verifier has checked so far: only those this
+    // program has touched since the boot ROM handed over
+    uart_puts("\nLazily Verified Pages: ");
+    uart_puthex(PV_VERIFIED);
+    uart_puts("\n");
+
+    // Re-check every page against the signed digest table with the
+    // crypto accelerator in plain SHA-256 mode
+    uart_puts("\nPage Digests (");
+    uart_puthex(header->page_count);
+    uart_puts(" x 4KB):\n");
+    uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
+    const uint32_t (*table)[8] = GET_FW_PAGE_TABLE();
+    int bad_pages = 0;
+    for (uint32_t p = 0; p < header->page_count; p++) {
+        uint32_t off = p * FW_PAGE_SIZE;
+        uint32_t len = header->length - off;
+        if (len > FW_PAGE_SIZE) {
+            len = FW_PAGE_SIZE;
+        }
+        CRYPTO_MSG_ADDR = FIRMWARE_BASE + off;
+        CRYPTO_MSG_LEN = len;
+        CRYPTO_MODE = CRYPTO_MODE_SHA256;
+        CRYPTO_CTRL = CRYPTO_CTRL_START;
+        while (!(CRYPTO_STATUS & CRYPTO_STATUS_DONE));
+
+        int match = 1;
+        for (int i = 0; i < 8; i++) {
+            if ((&CRYPTO_HASH_0)[i] != table[p][i]) {
+                match = 0;
+            }
+        }
+        uart_puts("  page ");
+        uart_puthex(p);
+        uart_puts(match ? " ✓\n" : " ✗ MISMATCH\n");
+        bad_pages += !match;
+    }
+    if (bad_pages == 0) {
+        uart_puts("  All pages match the signed table\n");
+    }
+    // Reading every page above made the verifier check all of them
+    uart_puts("  Verified bitmap now ");
+    uart_puthex(PV_VERIFIED);
+    uart_puts("\n");
+
     uart_puts("\n");
     uart_puts("Security Features Demonstrated:\n");
     uart_puts("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
@@ -88,6 +169,15 @@ void main(void) {
     uart_puts("╚════════════════════════════════════════╝\n\n");
     
     uart_puts("System is secure and ready.\n\n");
+    boot_log_dump();
+    uart_puts("\n");
+    
+    // Instruction memory is unchanged: a warm reset boots without the
+    // HMAC (the boot ROM prints "Cached"), then warm_boot_report() ends
+    // the simulation with EOT (0x04)
+    uart_puts("Warm reset...\n");
+    uart_flush();
+    BOOT_RESET = BOOT_WARM_RESET_KEY;
     
     // Infinite loop
     while(1) {
@@ -4,6 +4,10 @@ Firmware Signing Tool for Secure RISC-V SoC
 
 Generates HMAC-SHA256 signature and creates signed firmware image.
 
+The image is followed by a table of SHA-256 digests, one per 4KB page,
+and the header; the signature is the HMAC of the table and the header
+fields (see common/firmware_header.h).
+
 Usage:
     sign_firmware.py <firmware.bin> <key_hex> <version> <output.bin>
 
@@ -42,24 +46,55 @@ def sign_firmware(firmware_path, key_hex, version, output_path):
     print(f"Input firmware: {firmware_path}")
     print(f"  Size: {len(firmware_data)} bytes")
     
-    # Header will be at offset 0xFFC0 (65472)
-    header_offset = 0xFFC0
+    # Layout: image (64-byte aligned) | page digest table (64-byte
+    # aligned) | header. The last possible header offset is 0xFFC0
+    # (65472).
+    align = 0x40
+    header_max = 0xFFC0
+    header_off_offset = 0x08
+    page_size = 0x1000
+    
+    def align_up(n):
+        return (n + align - 1) & ~(align - 1)
     
-    if len(firmware_data) > header_offset:
+    length = align_up(len(firmware_data))
+    page_count = (length + page_size - 1) // page_size
+    table_size = align_up(page_count * 32)
+    header_offset = length + table_size
+    
+    if header_offset > header_max:
         print(f"\nERROR: Firmware too large!")
         print(f"  Current size: {len(firmware_data)} bytes")
-        print(f"  Maximum size: {header_offset} bytes")
-        print(f"  Overflow: {len(firmware_data) - header_offset} bytes")
+        print(f"  Maximum size: {header_max - table_size} bytes")
+        print(f"  Overflow: {header_offset - header_max} bytes")
         sys.exit(1)
     
-    # Pad firmware with zeros up to header offset
-    padding_needed = header_offset - len(firmware_data)
+    # The header offset word at +0x08 is reserved by start.S
+    if len(firmware_data) < header_off_offset + 4 or \
+            struct.unpack_from('<I', firmware_data, header_off_offset)[0] != 0:
+        print(f"\nERROR: No header offset word at offset 0x{header_off_offset:02X}!")
+        print(f"  (start.S must reserve it as zero)")
+        sys.exit(1)
+    
+    # Pad firmware with zeros up to the page table; the offset word is
+    # part of page 0, so it is set before the digests
+    padding_needed = length - len(firmware_data)
     firmware_data.extend(b'\x00' * padding_needed)
+    struct.pack_into('<I', firmware_data, header_off_offset, header_offset)
     print(f"  Padded to: {len(firmware_data)} bytes")
     
+    # Page digest table: SHA-256 of each page (the last may be short)
+    page_table = bytearray()
+    for i in range(page_count):
+        page = firmware_data[i * page_size:(i + 1) * page_size]
+        page_table += hashlib.sha256(page).digest()
+    page_table.extend(b'\x00' * (table_size - len(page_table)))
+    
+    print(f"\nPage table:")
+    print(f"  {page_count} x {page_size}-byte pages at offset 0x{length:04X}")
+    
     # Create firmware header
     magic = 0xDEADBEEF
-    length = len(firmware_data)
     entry_point = 0x00010000
     timestamp = int(datetime.now().timestamp())
     
@@ -69,19 +104,22 @@ def sign_firmware(firmware_path, key_hex, version, output_path):
     print(f"  Length:     {length} bytes")
     print(f"  Entry:      0x{entry_point:08X}")
     print(f"  Timestamp:  {timestamp} ({datetime.fromtimestamp(timestamp)})")
+    print(f"  Pages:      {page_count}")
     
     # Pack header (without signature yet)
-    # Format: magic, version, length, entry_point, timestamp, reserved[3]
-    header = struct.pack('<IIIIII',
+    # Format: magic, version, length, entry_point, timestamp, page_size,
+    # page_count, reserved
+    header = struct.pack('<IIIIIIII',
                         magic,
                         version,
                         length,
                         entry_point,
                         timestamp,
-                        0)  # reserved[0]
-    header += struct.pack('<II', 0, 0)  # reserved[1], reserved[2]
+                        page_size,
+                        page_count,
+                        0)  # reserved
     
-    # Calculate HMAC-SHA256 over firmware + header (without signature)
+    # Calculate HMAC-SHA256 over page table + header (without signature)
     try:
         key = bytes.fromhex(key_hex)
         if len(key) != 32:
@@ -95,8 +133,9 @@ def sign_firmware(firmware_path, key_hex, version, output_path):
     print(f"\nHMAC key:")
     print(f"  {key_hex}")
     
-    # Data to sign = firmware + header (without signature field)
-    data_to_sign = firmware_data + header
+    # Data to sign = page table + header (without signature field): a
+    # root over the page digests, which cover the image
+    data_to_sign = page_table + header
     
     print(f"\nCalculating HMAC-SHA256...")
     print(f"  Input data: {len(data_to_sign)} bytes")
@@ -118,7 +157,7 @@ def sign_firmware(firmware_path, key_hex, version, output_path):
         print(f"  [{i}] = 0x{word:08X}")
     
     # Write signed firmware
-    signed_firmware = firmware_data + header
+    signed_firmware = firmware_data + page_table + header
     
     try:
         with open(output_path, 'wb') as f:
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Instruction Trace Decoder for Secure RISC-V SoC
+
+Rebuilds the executed instruction path from a trace_unit dump
+(trace.txt, written by the testbench on trap and EOT) and the ELF
+images that were running (firmware.elf, optionally boot.elf).
+
+Each trace entry carries the number of instructions retired since the
+previous entry, so the path between two taken branches is recovered by
+walking the disassembly sequentially. Decoding starts at the first
+branch entry (its target is the first known PC) and resynchronises at
+the next branch whenever the PC leaves the known images or an IRQ
+starts.
+
+Usage:
+    trace_decode.py <trace.txt> <elf> [<elf> ...]
+
+Example:
+    trace_decode.py build/trace.txt build/firmware.elf build/boot.elf
+
+Set OBJDUMP to override the disassembler
+(default: riscv64-unknown-elf-objdump).
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+INFO_BRANCH = 1 << 0
+INFO_ADDR   = 1 << 1
+INFO_IRQ    = 1 << 3
+
+INSN_LINE = re.compile(r'^\s*([0-9a-f]+):\s+([0-9a-f]+)\s+(.*)$')
+SYM_LINE  = re.compile(r'^([0-9a-f]+) <(.+)>:$')
+
+
+def load_disassembly(elf_paths):
+    """
+    Returns {pc: (size, text, symbol)} for every instruction in the ELFs
+    """
+    objdump = os.environ.get('OBJDUMP', 'riscv64-unknown-elf-objdump')
+    insns = {}
+
+    for path in elf_paths:
+        try:
+            out = subprocess.run([objdump, '-d', '-M', 'no-aliases', path],
+                                 capture_output=True, text=True, check=True).stdout
+        except (OSError, subprocess.CalledProcessError) as e:
+            print(f"ERROR: cannot disassemble '{path}': {e}")
+            sys.exit(1)
+
+        symbol = '?'
+        for line in out.splitlines():
+            m = SYM_LINE.match(line)
+            if m:
+                symbol = m.group(2)
+                continue
+            m = INSN_LINE.match(line)
+            if m:
+                pc = int(m.group(1), 16)
+                size = len(m.group(2)) // 2
+                text = ' '.join(m.group(3).split())
+                insns[pc] = (size, text, symbol)
+
+    return insns
+
+
+def load_trace(trace_path):
+    """
+    Returns a list of (delta, flags, data) tuples, oldest first
+    """
+    entries = []
+    try:
+        with open(trace_path) as f:
+            for line in f:
+                line = line.strip()
+                if not line or line.startswith('#'):
+                    continue
+                info, data = (int(x, 16) for x in line.split())
+                entries.append((info >> 4, info & 0xF, data))
+    except FileNotFoundError:
+        print(f"ERROR: Trace file '{trace_path}' not found!")
+        sys.exit(1)
+
+    return entries
+
+
+def decode(entries, insns):
+    pc = None
+    in_irq = False
+    out = []
+
+    def step(count):
+        """Walk count instructions sequentially from pc"""
+        nonlocal pc
+        for _ in range(count):
+            if pc is None or pc not in insns:
+                if pc is not None:
+                    out.append(f"  ... 0x{pc:08x} outside known images, resync at next branch")
+                pc = None
+                return
+            size, text, symbol = insns[pc]
+            out.append(f"  {pc:08x}  {text:<40} <{symbol}>")
+            pc += size
+
+    for delta, flags, data in entries:
+        irq = bool(flags & INFO_IRQ)
+        if irq != in_irq:
+            out.append("-- IRQ entry --" if irq else "-- IRQ return --")
+            in_irq = irq
+            if irq:
+                # Entry point within the interrupted sequence is not recorded
+                pc = None
+
+        if flags & INFO_ADDR:
+            # Address of the load/store that retires after delta more instructions
+            step(delta)
+            out.append(f"      mem 0x{data:08x}")
+        elif flags & INFO_BRANCH:
+            # delta-th instruction is the taken branch to data
+            step(delta)
+            if pc is None:
+                out.append(f"-- sync at 0x{data:08x} --")
+            pc = data
+        else:
+            # delta-th instruction wrote data to its destination register
+            step(delta)
+            out.append(f"      rd = 0x{data:08x}")
+
+    # Instructions after the last entry are not known
+    if pc is not None:
+        out.append(f"  last PC in trace: 0x{pc:08x}")
+
+    return out
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        sys.exit(1)
+
+    entries = load_trace(sys.argv[1])
+    insns = load_disassembly(sys.argv[2:])
+
+    print(f"Trace entries: {len(entries)}")
+    for line in decode(entries, insns):
+        print(line)
+
+
+if __name__ == '__main__':
+    main()